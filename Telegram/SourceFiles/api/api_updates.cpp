@@ -68,6 +68,10 @@ namespace Api {
 namespace {
 
 constexpr auto kChannelGetDifferenceLimit = 100;
+constexpr auto kChannelDifferenceParallel = 8;
+
+// While catching up many channels notify about changes once in a while.
+constexpr auto kChannelDifferenceNotifyDelay = crl::time(200);
 
 // 1s wait after show channel history before sending getChannelDifference.
 constexpr auto kWaitForChannelGetDifference = crl::time(1000);
@@ -237,6 +241,9 @@ Updates::Updates(not_null<Main::Session*> session)
 , _bySeqTimer([=] { getDifference(); })
 , _byMinChannelTimer([=] { getDifference(); })
 , _failDifferenceTimer([=] { getDifferenceAfterFail(); })
+, _channelDifferenceNotifyTimer([=] {
+	session().data().sendHistoryChangeNotifications();
+})
 , _idleFinishTimer([=] { checkIdleFinish(); }) {
 	_ptsWaiter.setRequesting(true);
 
@@ -329,7 +336,15 @@ void Updates::feedUpdateVector(
 		}
 		feedUpdate(entry);
 	}
-	session().data().sendHistoryChangeNotifications();
+	if (_handlingChannelDifference && catchingUpChannels()) {
+		if (!_channelDifferenceNotifyTimer.isActive()) {
+			_channelDifferenceNotifyTimer.callOnce(
+				kChannelDifferenceNotifyDelay);
+		}
+	} else {
+		_channelDifferenceNotifyTimer.cancel();
+		session().data().sendHistoryChangeNotifications();
+	}
 }
 
 void Updates::checkForSentToScheduled(const MTPUpdates &updates) {
@@ -387,6 +402,9 @@ void Updates::channelDifferenceDone(
 		const MTPupdates_ChannelDifference &difference) {
 	_channelFailDifferenceTimeout.remove(channel);
 
+	// Deliver the changes of the whole difference as a single batch.
+	const auto hold = session().changes().holdNotifications();
+
 	const auto timeout = difference.match([&](const auto &data) {
 		return data.vtimeout().value_or_empty();
 	});
@@ -480,6 +498,8 @@ void Updates::stateDone(const MTPupdates_State &state) {
 void Updates::differenceDone(const MTPupdates_Difference &result) {
 	_failDifferenceTimeout = 1;
 
+	const auto hold = session().changes().holdNotifications();
+
 	switch (result.type()) {
 	case mtpc_updates_differenceEmpty: {
 		auto &d = result.c_updates_differenceEmpty();
@@ -717,7 +737,9 @@ void Updates::getChannelDifference(
 		_whenGetDiffByPts.remove(channel);
 	}
 
-	if (!channel->ptsInited() || channel->ptsRequesting()) {
+	if (!channel->ptsInited()
+		|| channel->ptsRequesting()
+		|| _channelDifferenceQueue.contains(channel)) {
 		return;
 	}
 
@@ -727,6 +749,19 @@ void Updates::getChannelDifference(
 
 	channel->ptsSetRequesting(true);
 
+	const auto sending = int(_channelDifferenceRequests.size());
+	if (sending >= kChannelDifferenceParallel) {
+		_channelDifferenceQueue.emplace(channel, from);
+		return;
+	}
+	sendChannelDifference(channel, from);
+}
+
+void Updates::sendChannelDifference(
+		not_null<ChannelData*> channel,
+		ChannelDifferenceRequest from) {
+	_channelDifferenceRequests.emplace(channel);
+
 	auto filter = MTP_channelMessagesFilterEmpty();
 	auto flags = MTPupdates_GetChannelDifference::Flag::f_force | 0;
 	if (from != ChannelDifferenceRequest::PtsGapOrShortPoll) {
@@ -741,12 +776,48 @@ void Updates::getChannelDifference(
 		MTP_int(channel->pts()),
 		MTP_int(kChannelGetDifferenceLimit)
 	)).done([=](const MTPupdates_ChannelDifference &result) {
+		_channelDifferenceRequests.remove(channel);
 		channelDifferenceDone(channel, result);
+		sendQueuedChannelDifferences();
 	}).fail([=](const MTP::Error &error) {
+		_channelDifferenceRequests.remove(channel);
 		channelDifferenceFail(channel, error);
+		sendQueuedChannelDifferences();
 	}).send();
 }
 
+void Updates::sendQueuedChannelDifferences() {
+	const auto priority = [&](not_null<ChannelData*> channel) {
+		const auto history = session().data().historyLoaded(channel);
+		const auto important = inActiveChats(channel)
+			? 2
+			: (history && history->isPinnedDialog(FilterId()))
+			? 1
+			: 0;
+		return std::make_pair(
+			important,
+			history ? history->chatListTimeId() : TimeId());
+	};
+	const auto full = [&] {
+		const auto sending = int(_channelDifferenceRequests.size());
+		return (sending >= kChannelDifferenceParallel);
+	};
+	while (!_channelDifferenceQueue.empty() && !full()) {
+		const auto i = ranges::max_element(
+			_channelDifferenceQueue,
+			ranges::less(),
+			[&](const auto &pair) { return priority(pair.first); });
+		const auto [channel, from] = *i;
+		_channelDifferenceQueue.erase(i);
+		sendChannelDifference(channel, from);
+	}
+}
+
+bool Updates::catchingUpChannels() const {
+	return !_channelDifferenceQueue.empty()
+		|| !_channelDifferenceRequests.empty();
+}
+
 void Updates::sendPing() {
 	_session->mtp().ping();
 }
@@ -105,6 +105,11 @@ private:
 	void getChannelDifference(
 		not_null<ChannelData*> channel,
 		ChannelDifferenceRequest from = ChannelDifferenceRequest::Unknown);
+	void sendChannelDifference(
+		not_null<ChannelData*> channel,
+		ChannelDifferenceRequest from);
+	void sendQueuedChannelDifferences();
+	[[nodiscard]] bool catchingUpChannels() const;
 	void differenceDone(const MTPupdates_Difference &result);
 	void differenceFail(const MTP::Error &error);
 	void feedDifference(
@@ -199,6 +204,14 @@ private:
 		not_null<ChannelData*>,
 		mtpRequestId> _rangeDifferenceRequests;
 
+	// At most kChannelDifferenceParallel requests are sent at once,
+	// the rest are waiting in the queue, most important chats first.
+	base::flat_set<not_null<ChannelData*>> _channelDifferenceRequests;
+	base::flat_map<
+		not_null<ChannelData*>,
+		ChannelDifferenceRequest> _channelDifferenceQueue;
+	base::Timer _channelDifferenceNotifyTimer;
+
 	crl::time _lastUpdateTime = 0;
 	bool _handlingChannelDifference = false;
 
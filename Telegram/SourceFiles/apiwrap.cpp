@@ -96,10 +96,12 @@ constexpr auto kTopPromotionMinDelay = TimeId(10);
 constexpr auto kSmallDelayMs = 5;
 constexpr auto kReadFeaturedSetsTimeout = crl::time(1000);
 constexpr auto kFileLoaderQueueStopTimeout = crl::time(5000);
+constexpr auto kFileLoaderWorkersMax = 4;
 constexpr auto kStickersByEmojiInvalidateTimeout = crl::time(6 * 1000);
 constexpr auto kNotifySettingSaveTimeout = crl::time(1000);
 constexpr auto kDialogsFirstLoad = 20;
 constexpr auto kDialogsPerPage = 500;
+constexpr auto kMessagesPerRequest = 100;
 constexpr auto kStatsSessionKillTimeout = 10 * crl::time(1000);
 
 using PhotoFileLocationId = Data::PhotoFileLocationId;
@@ -152,7 +154,9 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 , _draftsSaveTimer([=] { saveDraftsToCloud(); })
 , _featuredSetsReadTimer([=] { readFeaturedSets(); })
 , _dialogsLoadState(std::make_unique<DialogsLoadState>())
-, _fileLoader(std::make_unique<TaskQueue>(kFileLoaderQueueStopTimeout))
+, _fileLoader(std::make_unique<TaskQueue>(
+	kFileLoaderQueueStopTimeout,
+	std::clamp(QThread::idealThreadCount() - 1, 1, kFileLoaderWorkersMax)))
 , _topPromotionTimer([=] { refreshTopPromotion(); })
 , _updateNotifyTimer([=] { sendNotifySettingsUpdates(); })
 , _statsSessionKillTimer([=] { checkStatsSessions(); })
@@ -599,16 +603,35 @@ void ApiWrap::requestMessageData(
 QVector<MTPInputMessage> ApiWrap::collectMessageIds(
 		const MessageDataRequests &requests) {
 	auto result = QVector<MTPInputMessage>();
-	result.reserve(requests.size());
+	result.reserve(std::min(int(requests.size()), kMessagesPerRequest));
 	for (const auto &[msgId, request] : requests) {
 		if (request.requestId > 0) {
 			continue;
 		}
 		result.push_back(MTP_inputMessageID(MTP_int(msgId)));
+		if (result.size() == kMessagesPerRequest) {
+			break;
+		}
 	}
 	return result;
 }
 
+void ApiWrap::markMessageIdsRequested(
+		MessageDataRequests &requests,
+		int count,
+		mtpRequestId requestId) {
+	// Same order as in collectMessageIds().
+	for (auto &[msgId, request] : requests) {
+		if (request.requestId > 0) {
+			continue;
+		}
+		request.requestId = requestId;
+		if (!--count) {
+			break;
+		}
+	}
+}
+
 auto ApiWrap::messageDataRequests(ChannelData *channel, bool onlyExisting)
 -> MessageDataRequests* {
 	if (!channel) {
@@ -631,8 +654,13 @@ void ApiWrap::resolveMessageDatas() {
 		return;
 	}
 
-	const auto ids = collectMessageIds(_messageDataRequests);
-	if (!ids.isEmpty()) {
+	// Big bursts are split in chunks that are sent at once,
+	// so that they may share one container.
+	while (true) {
+		const auto ids = collectMessageIds(_messageDataRequests);
+		if (ids.isEmpty()) {
+			break;
+		}
 		const auto requestId = request(MTPmessages_GetMessages(
 			MTP_vector<MTPInputMessage>(ids)
 		)).done([=](
@@ -644,21 +672,19 @@ void ApiWrap::resolveMessageDatas() {
 			finalizeMessageDataRequest(nullptr, requestId);
 		}).afterDelay(kSmallDelayMs).send();
 
-		for (auto &[msgId, request] : _messageDataRequests) {
-			if (request.requestId > 0) {
-				continue;
-			}
-			request.requestId = requestId;
-		}
+		markMessageIdsRequested(_messageDataRequests, ids.size(), requestId);
 	}
 	for (auto j = _channelMessageDataRequests.begin(); j != _channelMessageDataRequests.cend();) {
 		if (j->second.empty()) {
 			j = _channelMessageDataRequests.erase(j);
 			continue;
 		}
-		const auto ids = collectMessageIds(j->second);
-		if (!ids.isEmpty()) {
-			const auto channel = j->first;
+		const auto channel = j->first;
+		while (true) {
+			const auto ids = collectMessageIds(j->second);
+			if (ids.isEmpty()) {
+				break;
+			}
 			const auto requestId = request(MTPchannels_GetMessages(
 				channel->inputChannel,
 				MTP_vector<MTPInputMessage>(ids)
@@ -671,12 +697,7 @@ void ApiWrap::resolveMessageDatas() {
 				finalizeMessageDataRequest(channel, requestId);
 			}).afterDelay(kSmallDelayMs).send();
 
-			for (auto &[msgId, request] : j->second) {
-				if (request.requestId > 0) {
-					continue;
-				}
-				request.requestId = requestId;
-			}
+			markMessageIdsRequested(j->second, ids.size(), requestId);
 		}
 		++j;
 	}
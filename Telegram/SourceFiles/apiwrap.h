@@ -470,6 +470,10 @@ private:
 
 	[[nodiscard]] QVector<MTPInputMessage> collectMessageIds(
 		const MessageDataRequests &requests);
+	void markMessageIdsRequested(
+		MessageDataRequests &requests,
+		int count,
+		mtpRequestId requestId);
 	[[nodiscard]] MessageDataRequests *messageDataRequests(
 		ChannelData *channel,
 		bool onlyExisting = false);
@@ -30,6 +30,62 @@ namespace ChatHelpers {
 namespace {
 
 constexpr auto kDontCacheLottieAfterArea = 512 * 512;
+constexpr auto kFramesMemoryLimit = int64(64 * 1024 * 1024);
+constexpr auto kFramesMemoryEntryLimit = kFramesMemoryLimit / 8;
+
+class FramesMemory final {
+public:
+	[[nodiscard]] std::optional<QByteArray> find(Storage::Cache::Key key);
+	void store(Storage::Cache::Key key, const QByteArray &cached);
+
+private:
+	struct Entry {
+		QByteArray cached;
+		uint64 used = 0;
+	};
+
+	QMutex _mutex;
+	base::flat_map<std::pair<uint64, uint64>, Entry> _entries;
+	int64 _size = 0;
+	uint64 _counter = 0;
+
+};
+
+std::optional<QByteArray> FramesMemory::find(Storage::Cache::Key key) {
+	QMutexLocker lock(&_mutex);
+	const auto i = _entries.find(std::make_pair(key.high, key.low));
+	if (i == end(_entries)) {
+		return std::nullopt;
+	}
+	i->second.used = ++_counter;
+	return i->second.cached;
+}
+
+void FramesMemory::store(
+		Storage::Cache::Key key,
+		const QByteArray &cached) {
+	if (cached.isEmpty() || cached.size() > kFramesMemoryEntryLimit) {
+		return;
+	}
+	QMutexLocker lock(&_mutex);
+	auto &entry = _entries[std::make_pair(key.high, key.low)];
+	_size += cached.size() - entry.cached.size();
+	entry.cached = cached;
+	entry.used = ++_counter;
+	while (_size > kFramesMemoryLimit) {
+		const auto i = ranges::min_element(
+			_entries,
+			ranges::less(),
+			[](const auto &pair) { return pair.second.used; });
+		_size -= i->second.cached.size();
+		_entries.erase(i);
+	}
+}
+
+[[nodiscard]] FramesMemory &SharedFramesMemory() {
+	static auto result = FramesMemory();
+	return result;
+}
 
 [[nodiscard]] uint64 LocalStickerId(QStringView name) {
 	auto full = u"local_sticker:"_q;
@@ -43,6 +99,35 @@ uint8 LottieCacheKeyShift(uint8 replacementsTag, StickerLottieSize sizeTag) {
 	return ((replacementsTag << 4) & 0xF0) | (uint8(sizeTag) & 0x0F);
 }
 
+void GetCachedFrames(
+		not_null<Main::Session*> session,
+		Storage::Cache::Key key,
+		FnMut<void(QByteArray &&cached)> done) {
+	if (auto cached = SharedFramesMemory().find(key)) {
+		// Same as cacheBigFile().get(), call done() not on main thread.
+		crl::async([
+			done = std::move(done),
+			cached = std::move(*cached)
+		]() mutable {
+			done(std::move(cached));
+		});
+		return;
+	}
+	session->data().cacheBigFile().get(key, [=, done = std::move(done)](
+			QByteArray &&cached) mutable {
+		SharedFramesMemory().store(key, cached);
+		done(std::move(cached));
+	});
+}
+
+void PutCachedFrames(
+		not_null<Main::Session*> session,
+		Storage::Cache::Key key,
+		QByteArray &&cached) {
+	SharedFramesMemory().store(key, cached);
+	session->data().cacheBigFile().put(key, std::move(cached));
+}
+
 template <typename Method>
 auto LottieCachedFromContent(
 		Method &&method,
@@ -56,14 +141,12 @@ auto LottieCachedFromContent(
 		baseKey.low + keyShift
 	};
 	const auto get = [=](FnMut<void(QByteArray &&cached)> handler) {
-		session->data().cacheBigFile().get(
-			key,
-			std::move(handler));
+		GetCachedFrames(session, key, std::move(handler));
 	};
 	const auto weak = base::make_weak(session);
 	const auto put = [=](QByteArray &&cached) {
 		crl::on_main(weak, [=, data = std::move(cached)]() mutable {
-			weak->data().cacheBigFile().put(key, std::move(data));
+			PutCachedFrames(weak.get(), key, std::move(data));
 		});
 	};
 	return method(
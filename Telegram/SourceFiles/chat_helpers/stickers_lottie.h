@@ -73,6 +73,18 @@ enum class StickerLottieSize : uint8 {
 	uint8 replacementsTag,
 	StickerLottieSize sizeTag);
 
+// Serialized frames caches of stickers and custom emoji go through
+// a memory layer above cacheBigFile(), so all the players of the same
+// media in the same size tier read it once and share the same bytes.
+void GetCachedFrames(
+	not_null<Main::Session*> session,
+	Storage::Cache::Key key,
+	FnMut<void(QByteArray &&cached)> done);
+void PutCachedFrames(
+	not_null<Main::Session*> session,
+	Storage::Cache::Key key,
+	QByteArray &&cached);
+
 [[nodiscard]] std::unique_ptr<Lottie::SinglePlayer> LottiePlayerFromDocument(
 	not_null<Data::DocumentMedia*> media,
 	StickerLottieSize sizeTag,
@@ -24,8 +24,11 @@ void Changes::Manager<DataType, UpdateType>::updated(
 			_updates.erase(i);
 		}
 		_stream.fire({ data, flags });
+	} else if (const auto i = _updates.find(data); i != _updates.end()) {
+		i->second |= flags;
+		++_suppressed;
 	} else {
-		_updates[data] |= flags;
+		_updates.emplace(data, flags);
 	}
 }
 
@@ -88,6 +91,11 @@ void Changes::Manager<DataType, UpdateType>::sendNotifications() {
 	}
 }
 
+template <typename DataType, typename UpdateType>
+int64 Changes::Manager<DataType, UpdateType>::suppressed() const {
+	return _suppressed;
+}
+
 Changes::Changes(not_null<Main::Session*> session) : _session(session) {
 }
 
@@ -307,14 +315,59 @@ rpl::producer<StoryUpdate> Changes::realtimeStoryUpdates(
 void Changes::scheduleNotifications() {
 	if (!_notify) {
 		_notify = true;
-		crl::on_main(&session(), [=] {
-			sendNotifications();
-		});
+		if (!_held) {
+			postNotifications();
+		}
+	}
+}
+
+void Changes::postNotifications() {
+	crl::on_main(&session(), [=] {
+		sendNotifications();
+	});
+}
+
+rpl::lifetime Changes::holdNotifications() {
+	if (!_held++) {
+		_suppressedOnHold = suppressedNotifications();
+	}
+	auto result = rpl::lifetime();
+	result.add([weak = base::make_weak(this)] {
+		if (const auto strong = weak.get()) {
+			strong->releaseNotifications();
+		}
+	});
+	return result;
+}
+
+void Changes::releaseNotifications() {
+	Expects(_held > 0);
+
+	if (--_held) {
+		return;
+	}
+	const auto suppressed = suppressedNotifications() - _suppressedOnHold;
+	if (suppressed > 0) {
+		DEBUG_LOG(("Changes: %1 duplicate updates merged while held."
+			).arg(suppressed));
+	}
+	if (_notify) {
+		// Deliver the whole batch once on the next event loop turn.
+		postNotifications();
 	}
 }
 
+int64 Changes::suppressedNotifications() const {
+	return _peerChanges.suppressed()
+		+ _historyChanges.suppressed()
+		+ _topicChanges.suppressed()
+		+ _messageChanges.suppressed()
+		+ _entryChanges.suppressed()
+		+ _storyChanges.suppressed();
+}
+
 void Changes::sendNotifications() {
-	if (!_notify) {
+	if (!_notify || _held) {
 		return;
 	}
 	_notify = false;
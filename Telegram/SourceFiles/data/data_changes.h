@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/flags.h"
+#include "base/weak_ptr.h"
 
 class History;
 class PeerData;
@@ -247,7 +248,7 @@ struct StoryUpdate {
 
 };
 
-class Changes final {
+class Changes final : public base::has_weak_ptr {
 public:
 	explicit Changes(not_null<Main::Session*> session);
 
@@ -346,6 +347,11 @@ public:
 
 	void sendNotifications();
 
+	// While held the scheduled updates are only merged per object, even
+	// explicit sendNotifications() calls are postponed till the release.
+	[[nodiscard]] rpl::lifetime holdNotifications();
+	[[nodiscard]] int64 suppressedNotifications() const;
+
 private:
 	template <typename DataType, typename UpdateType>
 	class Manager final {
@@ -371,6 +377,8 @@ private:
 
 		void sendNotifications();
 
+		[[nodiscard]] int64 suppressed() const;
+
 	private:
 		static constexpr auto kCount = details::CountBit<Flag>() + 1;
 
@@ -381,10 +389,13 @@ private:
 		std::array<rpl::event_stream<UpdateType>, kCount> _realtimeStreams;
 		base::flat_map<not_null<DataType*>, Flags> _updates;
 		rpl::event_stream<UpdateType> _stream;
+		int64 _suppressed = 0;
 
 	};
 
 	void scheduleNotifications();
+	void postNotifications();
+	void releaseNotifications();
 
 	const not_null<Main::Session*> _session;
 
@@ -396,6 +407,8 @@ private:
 	Manager<Dialogs::Entry, EntryUpdate> _entryChanges;
 	Manager<Story, StoryUpdate> _storyChanges;
 
+	int _held = 0;
+	int64 _suppressedOnHold = 0;
 	bool _notify = false;
 
 };
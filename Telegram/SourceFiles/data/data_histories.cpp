@@ -19,6 +19,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_user.h"
 #include "base/unixtime.h"
 #include "base/random.h"
+#include "base/options.h"
 #include "main/main_session.h"
 #include "window/notifications_manager.h"
 #include "history/history.h"
@@ -33,9 +34,32 @@ namespace {
 
 constexpr auto kReadRequestTimeout = 3 * crl::time(1000);
 constexpr auto kReportDeliveriesPerRequest = 50;
+constexpr auto kUnloadHiddenViewsBudget = 10'000;
+constexpr auto kUnloadHiddenViewsBudgetSmall = 2'000;
+constexpr auto kUnloadHiddenAfter = 30 * 60 * crl::time(1000);
+constexpr auto kUnloadHiddenAfterSmall = 5 * 60 * crl::time(1000);
+constexpr auto kUnloadHiddenCheckTimeout = 60 * crl::time(1000);
+
+base::options::toggle UnloadHiddenChatsSooner({
+	.id = kOptionUnloadHiddenChatsSooner,
+	.name = "Unload hidden chats sooner",
+	.description = "Drop the message layouts of chats hidden for 5 minutes "
+		"or beyond 2000 messages in all hidden chats, instead of 30 minutes "
+		"and 10000 messages. The messages themselves stay in memory.",
+});
+
+[[nodiscard]] int LoadedViewsCount(not_null<History*> history) {
+	auto result = 0;
+	for (const auto &block : history->blocks) {
+		result += int(block->messages.size());
+	}
+	return result;
+}
 
 } // namespace
 
+const char kOptionUnloadHiddenChatsSooner[] = "unload-hidden-chats-sooner";
+
 MTPInputReplyTo ReplyToForMTP(
 		not_null<History*> history,
 		FullReplyTo replyTo) {
@@ -102,7 +126,8 @@ MTPInputMedia WebPageForMTP(
 
 Histories::Histories(not_null<Session*> owner)
 : _owner(owner)
-, _readRequestsTimer([=] { sendReadRequests(); }) {
+, _readRequestsTimer([=] { sendReadRequests(); })
+, _unloadHiddenTimer([=] { checkUnloadHidden(); }) {
 }
 
 Session &Histories::owner() const {
@@ -134,12 +159,65 @@ void Histories::unloadAll() {
 	for (const auto &[peerId, history] : _map) {
 		history->clear(History::ClearType::Unload);
 	}
+	_hiddenAt.clear();
 }
 
 void Histories::clearAll() {
+	_shown.clear();
+	_hiddenAt.clear();
 	_map.clear();
 }
 
+void Histories::historyShown(not_null<History*> history) {
+	++_shown[history];
+	_hiddenAt.remove(history);
+}
+
+void Histories::historyHidden(not_null<History*> history) {
+	const auto i = _shown.find(history);
+	if (i == end(_shown)) {
+		return;
+	} else if (--i->second > 0) {
+		return;
+	}
+	_shown.erase(i);
+	if (!history->isEmpty()) {
+		_hiddenAt[history] = crl::now();
+		if (!_unloadHiddenTimer.isActive()) {
+			_unloadHiddenTimer.callOnce(kUnloadHiddenCheckTimeout);
+		}
+	}
+}
+
+void Histories::checkUnloadHidden() {
+	auto list = std::vector<std::pair<crl::time, not_null<History*>>>();
+	list.reserve(_hiddenAt.size());
+	auto total = 0;
+	for (const auto &[history, when] : _hiddenAt) {
+		list.emplace_back(when, history);
+		total += LoadedViewsCount(history);
+	}
+	ranges::sort(list);
+
+	const auto sooner = UnloadHiddenChatsSooner.value();
+	const auto budget = sooner
+		? kUnloadHiddenViewsBudgetSmall
+		: kUnloadHiddenViewsBudget;
+	const auto after = sooner ? kUnloadHiddenAfterSmall : kUnloadHiddenAfter;
+	const auto now = crl::now();
+	for (const auto &[when, history] : list) {
+		if (total <= budget && now - when < after) {
+			break;
+		}
+		total -= LoadedViewsCount(history);
+		history->clear(History::ClearType::Unload);
+		_hiddenAt.remove(history);
+	}
+	if (!_hiddenAt.empty()) {
+		_unloadHiddenTimer.callOnce(kUnloadHiddenCheckTimeout);
+	}
+}
+
 void Histories::readInbox(not_null<History*> history) {
 	DEBUG_LOG(("Reading: readInbox called."));
 	if (history->lastServerMessageKnown()) {
@@ -57,6 +57,12 @@ public:
 	void unloadAll();
 	void clearAll();
 
+	// Message views of histories hidden for a long time or beyond the
+	// total budget are unloaded, they're requested again when shown.
+	// The items themselves are not destroyed.
+	void historyShown(not_null<History*> history);
+	void historyHidden(not_null<History*> history);
+
 	void readInbox(not_null<History*> history);
 	void readInboxTill(not_null<HistoryItem*> item);
 	void readInboxTill(not_null<History*> history, MsgId tillId);
@@ -204,6 +210,8 @@ private:
 	void sendDialogRequests();
 	void reportPendingDeliveries();
 
+	void checkUnloadHidden();
+
 	[[nodiscard]] bool isCreatingTopic(
 		not_null<History*> history,
 		MsgId rootId) const;
@@ -243,6 +251,12 @@ private:
 		base::flat_set<MsgId>> _pendingDeliveryReport;
 	base::flat_set<not_null<PeerData*>> _deliveryReportSent;
 
+	base::flat_map<not_null<History*>, int> _shown;
+	base::flat_map<not_null<History*>, crl::time> _hiddenAt;
+	base::Timer _unloadHiddenTimer;
+
 };
 
+extern const char kOptionUnloadHiddenChatsSooner[];
+
 } // namespace Data
@@ -22,8 +22,15 @@ namespace Data {
 namespace {
 
 constexpr auto kDefaultPreloadPrefix = 4 * 1024 * 1024;
+constexpr auto kMinPreloadPrefix = 256 * 1024;
+constexpr auto kDefaultViewDuration = 5 * crl::time(1000);
+constexpr auto kMaxViewDuration = 30 * crl::time(1000);
+constexpr auto kMinShownInterval = crl::time(100);
+constexpr auto kFastViewDuration = 2 * crl::time(1000);
+constexpr auto kSlowViewDuration = 10 * crl::time(1000);
+constexpr auto kFastLinkFactor = 4;
 
-[[nodiscard]] int64 ChoosePreloadPrefix(not_null<DocumentData*> video) {
+[[nodiscard]] int64 DefaultPreloadPrefix(not_null<DocumentData*> video) {
 	const auto result = video->videoPreloadPrefix();
 	return result
 		? result
@@ -32,6 +39,63 @@ constexpr auto kDefaultPreloadPrefix = 4 * 1024 * 1024;
 
 } // namespace
 
+PreloadScheduler::PreloadScheduler(not_null<Session*> owner)
+: _owner(owner) {
+}
+
+void PreloadScheduler::mediaShown() {
+	const auto now = crl::now();
+	const auto duration = now - _lastShown;
+	if (duration < kMinShownInterval) {
+		return;
+	}
+	const auto first = !_lastShown;
+	_lastShown = now;
+	if (first) {
+		return;
+	}
+	const auto sample = std::min(duration, kMaxViewDuration);
+	_viewDuration = _viewDuration
+		? ((_viewDuration * 3 + sample) / 4)
+		: sample;
+}
+
+void PreloadScheduler::resetPace() {
+	_lastShown = 0;
+	_viewDuration = 0;
+}
+
+int PreloadScheduler::aheadCount() const {
+	const auto duration = _viewDuration
+		? _viewDuration
+		: kDefaultViewDuration;
+	return (duration < kFastViewDuration)
+		? 5
+		: (duration > kSlowViewDuration)
+		? 2
+		: 3;
+}
+
+int64 PreloadScheduler::videoPrefix(not_null<DocumentData*> video) const {
+	const auto base = DefaultPreloadPrefix(video);
+	const auto throughput = _owner->session().downloader().throughput();
+	if (!throughput) {
+		return base;
+	}
+	const auto duration = _viewDuration
+		? _viewDuration
+		: kDefaultViewDuration;
+
+	// What we can receive for each media ahead while the current is shown.
+	const auto share = throughput * duration / crl::time(1000) / aheadCount();
+	const auto result = (share >= base * kFastLinkFactor)
+		? (base / 2) // The rest will arrive in time on a fast link.
+		: std::min(share, base);
+	return std::min(
+		std::max(result, int64(kMinPreloadPrefix)),
+		video->size);
+}
+
 MediaPreload::MediaPreload(Fn<void()> done)
 : _done(std::move(done)) {
 }
@@ -123,14 +187,15 @@ void VideoPreload::load() {
 		callDone();
 		return;
 	}
-	const auto prefix = ChoosePreloadPrefix(_video);
+	const auto prefix = _video->owner().preloadScheduler().videoPrefix(
+		_video);
 	Assert(prefix > 0 && prefix <= _video->size);
 	const auto part = Storage::kDownloadPartSize;
 	const auto parts = (prefix + part - 1) / part;
 	for (auto i = 0; i != parts; ++i) {
 		_parts.emplace(i * part, QByteArray());
 	}
-	addToQueue();
+	addToQueue(PreloadScheduler::kPriority);
 }
 
 void VideoPreload::done(QByteArray result) {
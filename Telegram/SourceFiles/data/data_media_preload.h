@@ -11,9 +11,33 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Data {
 
+class Session;
 class PhotoMedia;
 struct FileOrigin;
 
+// Chooses how much and how far ahead to preload from the measured
+// download speed and from how fast the user goes through the media.
+class PreloadScheduler final {
+public:
+	explicit PreloadScheduler(not_null<Session*> owner);
+
+	// Preloads are requested after all foreground downloads.
+	static constexpr auto kPriority = -1;
+
+	void mediaShown();
+	void resetPace(); // When the viewer is closed.
+
+	[[nodiscard]] int aheadCount() const;
+	[[nodiscard]] int64 videoPrefix(not_null<DocumentData*> video) const;
+
+private:
+	const not_null<Session*> _owner;
+
+	crl::time _lastShown = 0;
+	crl::time _viewDuration = 0;
+
+};
+
 class MediaPreload {
 public:
 	explicit MediaPreload(Fn<void()> done);
@@ -0,0 +1,149 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_messages_index.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kMinCapacity = 16;
+
+// Keep the load factor at most 3/4 and shrink below 1/8.
+[[nodiscard]] bool TooDense(int size, int capacity) {
+	return (size * 4 > capacity * 3);
+}
+
+[[nodiscard]] bool TooSparse(int size, int capacity) {
+	return (capacity > kMinCapacity) && (size * 8 < capacity);
+}
+
+[[nodiscard]] uint64 Hash(FullMsgId id) {
+	auto result = id.peer.value * 0x9E3779B97F4A7C15ULL
+		^ uint64(id.msg.bare);
+	result ^= result >> 33;
+	result *= 0xFF51AFD7ED558CCDULL;
+	result ^= result >> 33;
+	return result;
+}
+
+[[nodiscard]] uint64 Hash(MsgId id) {
+	auto result = uint64(id.bare) * 0x9E3779B97F4A7C15ULL;
+	result ^= result >> 33;
+	return result;
+}
+
+} // namespace
+
+template <typename Key>
+int MessagesIndex<Key>::mask() const {
+	return int(_slots.size()) - 1;
+}
+
+template <typename Key>
+int MessagesIndex<Key>::indexOf(Key id) const {
+	return int(Hash(id) & uint64(mask()));
+}
+
+template <typename Key>
+int MessagesIndex<Key>::lookup(Key id) const {
+	if (_slots.empty()) {
+		return -1;
+	}
+	for (auto i = indexOf(id);; i = (i + 1) & mask()) {
+		const auto &slot = _slots[i];
+		if (!slot.item) {
+			return -1;
+		} else if (slot.id == id) {
+			return i;
+		}
+	}
+}
+
+template <typename Key>
+HistoryItem *MessagesIndex<Key>::find(Key id) const {
+	const auto i = lookup(id);
+	return (i >= 0) ? _slots[i].item : nullptr;
+}
+
+template <typename Key>
+HistoryItem *MessagesIndex<Key>::insert(
+		Key id,
+		not_null<HistoryItem*> item) {
+	if (_slots.empty() || TooDense(_size + 1, int(_slots.size()))) {
+		rehash(std::max(int(_slots.size()) * 2, kMinCapacity));
+	}
+	for (auto i = indexOf(id);; i = (i + 1) & mask()) {
+		auto &slot = _slots[i];
+		if (!slot.item) {
+			slot = { id, item.get() };
+			++_size;
+			return nullptr;
+		} else if (slot.id == id) {
+			return std::exchange(slot.item, item.get());
+		}
+	}
+}
+
+template <typename Key>
+HistoryItem *MessagesIndex<Key>::take(Key id) {
+	auto i = lookup(id);
+	if (i < 0) {
+		return nullptr;
+	}
+	const auto result = std::exchange(_slots[i].item, nullptr);
+	--_size;
+
+	// Move back the following entries of the probe sequence.
+	for (auto j = (i + 1) & mask();; j = (j + 1) & mask()) {
+		auto &slot = _slots[j];
+		if (!slot.item) {
+			break;
+		}
+		const auto home = indexOf(slot.id);
+		const auto movable = (i <= j)
+			? (home <= i || home > j)
+			: (home <= i && home > j);
+		if (movable) {
+			_slots[i] = std::exchange(slot, Slot());
+			i = j;
+		}
+	}
+	if (TooSparse(_size, int(_slots.size()))) {
+		rehash(int(_slots.size()) / 2);
+	}
+	return result;
+}
+
+template <typename Key>
+void MessagesIndex<Key>::clear() {
+	base::take(_slots);
+	_size = 0;
+}
+
+template <typename Key>
+void MessagesIndex<Key>::rehash(int capacity) {
+	Expects(capacity >= kMinCapacity);
+	Expects(!(capacity & (capacity - 1)));
+	Expects(!TooDense(_size, capacity));
+
+	auto was = std::exchange(_slots, std::vector<Slot>(capacity));
+	for (const auto &slot : was) {
+		if (slot.item) {
+			for (auto i = indexOf(slot.id);; i = (i + 1) & mask()) {
+				if (!_slots[i].item) {
+					_slots[i] = slot;
+					break;
+				}
+			}
+		}
+	}
+}
+
+template class MessagesIndex<FullMsgId>;
+template class MessagesIndex<MsgId>;
+
+} // namespace Data
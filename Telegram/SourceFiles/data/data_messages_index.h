@@ -0,0 +1,63 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "data/data_msg_id.h"
+
+class HistoryItem;
+
+namespace Data {
+
+// Open addressing id -> HistoryItem index, one flat array without
+// per-entry allocations, linear probing and backward shift removal,
+// so there are no tombstones to clean up.
+//
+// Instantiated for FullMsgId and for MsgId, see data_messages_index.cpp.
+template <typename Key>
+class MessagesIndex final {
+public:
+	[[nodiscard]] HistoryItem *find(Key id) const;
+
+	// Returns the item previously registered with the same id, if any.
+	HistoryItem *insert(Key id, not_null<HistoryItem*> item);
+	HistoryItem *take(Key id);
+	void clear();
+
+	[[nodiscard]] int size() const {
+		return _size;
+	}
+	[[nodiscard]] int64 memoryUsage() const {
+		return int64(_slots.size()) * sizeof(Slot);
+	}
+
+	template <typename Method>
+	void enumerate(Method &&method) const {
+		for (const auto &slot : _slots) {
+			if (slot.item) {
+				method(slot.id, not_null<HistoryItem*>(slot.item));
+			}
+		}
+	}
+
+private:
+	struct Slot {
+		Key id;
+		HistoryItem *item = nullptr;
+	};
+
+	[[nodiscard]] int mask() const;
+	[[nodiscard]] int indexOf(Key id) const;
+	[[nodiscard]] int lookup(Key id) const;
+	void rehash(int capacity);
+
+	std::vector<Slot> _slots;
+	int _size = 0;
+
+};
+
+} // namespace Data
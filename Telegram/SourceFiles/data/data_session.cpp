@@ -67,6 +67,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_saved_messages.h"
 #include "data/data_saved_sublist.h"
 #include "data/data_stories.h"
+#include "data/data_media_preload.h"
 #include "data/data_streaming.h"
 #include "data/data_media_rotation.h"
 #include "data/data_histories.h"
@@ -246,6 +247,7 @@ Session::Session(not_null<Main::Session*> session)
 , _notifySettings(std::make_unique<NotifySettings>(this))
 , _customEmojiManager(std::make_unique<CustomEmojiManager>(this))
 , _stories(std::make_unique<Stories>(this))
+, _preloadScheduler(std::make_unique<PreloadScheduler>(this))
 , _savedMessages(std::make_unique<SavedMessages>(this))
 , _chatbots(std::make_unique<Chatbots>(this))
 , _businessInfo(std::make_unique<BusinessInfo>(this))
@@ -392,8 +394,8 @@ void Session::clear() {
 	_session->scheduledMessages().clear();
 	_session->sponsoredMessages().clear();
 	_dependentMessages.clear();
-	base::take(_messages);
-	base::take(_nonChannelMessages);
+	_messages.clear();
+	_nonChannelMessages.clear();
 	_messageByRandomId.clear();
 	_sentMessagesData.clear();
 	cSetRecentInlineBots(RecentInlineBots());
@@ -1655,27 +1657,23 @@ rpl::producer<GiftUpdate> Session::giftUpdates() const {
 }
 
 HistoryItem *Session::changeMessageId(PeerId peerId, MsgId wasId, MsgId nowId) {
-	const auto list = messagesListForInsert(peerId);
-	const auto i = list->find(wasId);
-	if (i == list->end()) {
+	const auto item = _messages.take({ peerId, wasId });
+	if (!item) {
 		return nullptr;
 	}
-	const auto item = i->second;
-	list->erase(i);
-	const auto &[j, ok] = list->emplace(nowId, item);
+	const auto replaced = _messages.insert({ peerId, nowId }, item);
 
 	if (!peerIsChannel(peerId)) {
 		if (IsServerMsgId(wasId)) {
-			const auto k = _nonChannelMessages.find(wasId);
-			Assert(k != end(_nonChannelMessages));
-			_nonChannelMessages.erase(k);
+			const auto removed = _nonChannelMessages.take(wasId);
+			Assert(removed == item);
 		}
 		if (IsServerMsgId(nowId)) {
-			_nonChannelMessages.emplace(nowId, item);
+			_nonChannelMessages.insert(nowId, item);
 		}
 	}
 
-	Ensures(ok);
+	Ensures(!replaced);
 	return item;
 }
 
@@ -2437,29 +2435,17 @@ void Session::processExistingMessages(
 	});
 }
 
-const Session::Messages *Session::messagesList(PeerId peerId) const {
-	const auto i = _messages.find(peerId);
-	return (i != end(_messages)) ? &i->second : nullptr;
-}
-
-auto Session::messagesListForInsert(PeerId peerId)
--> not_null<Messages*> {
-	return &_messages[peerId];
-}
-
 void Session::registerMessage(not_null<HistoryItem*> item) {
 	const auto peerId = item->history()->peer->id;
-	const auto list = messagesListForInsert(peerId);
 	const auto itemId = item->id;
-	const auto i = list->find(itemId);
-	if (i != list->end()) {
+	if (const auto existing = _messages.find({ peerId, itemId })) {
 		LOG(("App Error: Trying to re-registerMessage()."));
-		i->second->destroy();
+		existing->destroy();
 	}
-	list->emplace(itemId, item);
+	_messages.insert({ peerId, itemId }, item);
 
 	if (!peerIsChannel(peerId) && IsServerMsgId(itemId)) {
-		_nonChannelMessages.emplace(itemId, item);
+		_nonChannelMessages.insert(itemId, item);
 	}
 }
 
@@ -2509,7 +2495,9 @@ void Session::checkTTLs() {
 	_ttlCheckTimer.cancel();
 	const auto now = base::unixtime::now();
 	while (!_ttlMessages.empty() && _ttlMessages.begin()->first <= now) {
-		_ttlMessages.begin()->second.front()->destroy();
+		const auto item = _ttlMessages.begin()->second.front();
+		_session->local().clearHistorySlice(item->history()->peer->id);
+		item->destroy();
 	}
 	scheduleNextTTLs();
 }
@@ -2517,18 +2505,15 @@ void Session::checkTTLs() {
 void Session::processMessagesDeleted(
 		PeerId peerId,
 		const QVector<MTPint> &data) {
-	const auto list = messagesList(peerId);
-	const auto affected = historyLoaded(peerId);
-	if (!list && !affected) {
-		return;
-	}
+	// The locally cached latest page may have any of them.
+	_session->local().clearHistorySlice(peerId);
 
+	const auto affected = historyLoaded(peerId);
 	auto historiesToCheck = base::flat_set<not_null<History*>>();
 	for (const auto &messageId : data) {
-		const auto i = list ? list->find(messageId.v) : Messages::iterator();
-		if (list && i != list->end()) {
-			const auto history = i->second->history();
-			i->second->destroy();
+		if (const auto item = _messages.find({ peerId, messageId.v })) {
+			const auto history = item->history();
+			item->destroy();
 			if (!history->chatListMessageKnown()) {
 				historiesToCheck.emplace(history);
 			}
@@ -2543,15 +2528,23 @@ void Session::processMessagesDeleted(
 
 void Session::processNonChannelMessagesDeleted(const QVector<MTPint> &data) {
 	auto historiesToCheck = base::flat_set<not_null<History*>>();
+	auto unknownDeleted = false;
 	for (const auto &messageId : data) {
 		if (const auto item = nonChannelMessage(messageId.v)) {
 			const auto history = item->history();
+			_session->local().clearHistorySlice(history->peer->id);
 			item->destroy();
 			if (!history->chatListMessageKnown()) {
 				historiesToCheck.emplace(history);
 			}
+		} else {
+			unknownDeleted = true;
 		}
 	}
+	if (unknownDeleted) {
+		// We don't know which locally cached page had those messages.
+		_session->local().clearNonChannelHistorySlices();
+	}
 	for (const auto &history : historiesToCheck) {
 		history->requestChatListMessage();
 	}
@@ -2595,10 +2588,10 @@ void Session::unregisterMessage(not_null<HistoryItem*> item) {
 			++i;
 		}
 	}
-	messagesListForInsert(peerId)->erase(itemId);
+	_messages.take({ peerId, itemId });
 
 	if (!peerIsChannel(peerId) && IsServerMsgId(itemId)) {
-		_nonChannelMessages.erase(itemId);
+		_nonChannelMessages.take(itemId);
 	}
 }
 
@@ -2623,17 +2616,7 @@ bool Session::suggestToGigagroup(not_null<ChannelData*> group) const {
 }
 
 HistoryItem *Session::message(PeerId peerId, MsgId itemId) const {
-	if (!itemId) {
-		return nullptr;
-	}
-
-	const auto data = messagesList(peerId);
-	if (!data) {
-		return nullptr;
-	}
-
-	const auto i = data->find(itemId);
-	return (i != data->end()) ? i->second.get() : nullptr;
+	return itemId ? _messages.find({ peerId, itemId }) : nullptr;
 }
 
 HistoryItem *Session::message(
@@ -2650,8 +2633,39 @@ HistoryItem *Session::nonChannelMessage(MsgId itemId) const {
 	if (!IsServerMsgId(itemId)) {
 		return nullptr;
 	}
-	const auto i = _nonChannelMessages.find(itemId);
-	return (i != end(_nonChannelMessages)) ? i->second.get() : nullptr;
+	return _nonChannelMessages.find(itemId);
+}
+
+std::vector<MessagesMemoryUsage> Session::messagesMemoryReport() const {
+	auto byPeer = base::flat_map<PeerId, MessagesMemoryUsage>();
+	auto total = MessagesMemoryUsage{
+		.bytes = _messages.memoryUsage() + _nonChannelMessages.memoryUsage(),
+	};
+	_messages.enumerate([&](FullMsgId id, not_null<HistoryItem*> item) {
+		const auto &text = item->originalText();
+		const auto bytes = int64(sizeof(HistoryItem))
+			+ text.text.capacity() * int64(sizeof(QChar))
+			+ text.entities.size() * int64(sizeof(EntityInText))
+			+ (item->mainView() ? int64(sizeof(HistoryView::Element)) : 0);
+		auto &usage = byPeer[id.peer];
+		usage.peer = id.peer;
+		++usage.count;
+		usage.bytes += bytes;
+		++total.count;
+		total.bytes += bytes;
+	});
+	auto result = std::vector<MessagesMemoryUsage>();
+	result.reserve(byPeer.size() + 1);
+	result.push_back(total);
+	for (const auto &[peer, usage] : byPeer) {
+		result.push_back(usage);
+	}
+	ranges::sort(
+		begin(result) + 1,
+		end(result),
+		ranges::greater(),
+		&MessagesMemoryUsage::bytes);
+	return result;
 }
 
 void Session::updateDependentMessages(not_null<HistoryItem*> item) {
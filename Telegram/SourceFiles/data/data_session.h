@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "dialogs/dialogs_main_list.h"
 #include "data/data_groups.h"
 #include "data/data_cloud_file.h"
+#include "data/data_messages_index.h"
 #include "history/history_location_manager.h"
 #include "base/timer.h"
 
@@ -65,6 +66,7 @@ class GroupCall;
 class NotifySettings;
 class CustomEmojiManager;
 class Stories;
+class PreloadScheduler;
 class SavedMessages;
 class Chatbots;
 class BusinessInfo;
@@ -90,6 +92,12 @@ struct GiftUpdate {
 	Action action = {};
 };
 
+struct MessagesMemoryUsage {
+	PeerId peer = 0;
+	int count = 0;
+	int64 bytes = 0;
+};
+
 struct SentToScheduled {
 	not_null<History*> history;
 	MsgId scheduledId = 0;
@@ -163,6 +171,9 @@ public:
 	[[nodiscard]] Stories &stories() const {
 		return *_stories;
 	}
+	[[nodiscard]] PreloadScheduler &preloadScheduler() const {
+		return *_preloadScheduler;
+	}
 	[[nodiscard]] SavedMessages &savedMessages() const {
 		return *_savedMessages;
 	}
@@ -475,6 +486,10 @@ public:
 
 	[[nodiscard]] HistoryItem *nonChannelMessage(MsgId itemId) const;
 
+	// Approximate, sorted from the heaviest peer, first entry is total.
+	[[nodiscard]] std::vector<MessagesMemoryUsage> messagesMemoryReport(
+		) const;
+
 	void updateDependentMessages(not_null<HistoryItem*> item);
 	void registerDependentMessage(
 		not_null<HistoryItem*> dependent,
@@ -812,8 +827,6 @@ public:
 	void clearLocalStorage();
 
 private:
-	using Messages = std::unordered_map<MsgId, not_null<HistoryItem*>>;
-
 	void suggestStartExport();
 
 	void setupMigrationViewer();
@@ -835,8 +848,6 @@ private:
 		Folder *requestFolder,
 		const MTPDdialogFolder &data);
 
-	const Messages *messagesList(PeerId peerId) const;
-	not_null<Messages*> messagesListForInsert(PeerId peerId);
 	not_null<HistoryItem*> registerMessage(
 		std::unique_ptr<HistoryItem> item);
 	HistoryItem *changeMessageId(PeerId peerId, MsgId wasId, MsgId nowId);
@@ -989,14 +1000,14 @@ private:
 	Dialogs::IndexedList _contactsNoChatsList;
 
 	MsgId _localMessageIdCounter = StartClientMsgId;
-	std::unordered_map<PeerId, Messages> _messages;
+	MessagesIndex<FullMsgId> _messages;
 	std::map<
 		not_null<HistoryItem*>,
 		base::flat_set<not_null<HistoryItem*>>> _dependentMessages;
 	std::map<TimeId, base::flat_set<not_null<HistoryItem*>>> _ttlMessages;
 	base::Timer _ttlCheckTimer;
 
-	std::unordered_map<MsgId, not_null<HistoryItem*>> _nonChannelMessages;
+	MessagesIndex<MsgId> _nonChannelMessages;
 
 	base::flat_map<uint64, FullMsgId> _messageByRandomId;
 	base::flat_map<uint64, SentData> _sentMessagesData;
@@ -1135,6 +1146,7 @@ private:
 	const std::unique_ptr<NotifySettings> _notifySettings;
 	const std::unique_ptr<CustomEmojiManager> _customEmojiManager;
 	const std::unique_ptr<Stories> _stories;
+	const std::unique_ptr<PreloadScheduler> _preloadScheduler;
 	const std::unique_ptr<SavedMessages> _savedMessages;
 	const std::unique_ptr<Chatbots> _chatbots;
 	const std::unique_ptr<BusinessInfo> _businessInfo;
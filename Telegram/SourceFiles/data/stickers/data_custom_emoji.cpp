@@ -43,6 +43,7 @@ namespace Data {
 namespace {
 
 constexpr auto kMaxPerRequest = 100;
+constexpr auto kMaxRequestsInFlight = 4;
 #if 0 // inject-to-on_main
 constexpr auto kUnsubscribeUpdatesDelay = 3 * crl::time(1000);
 #endif
@@ -316,7 +317,8 @@ void CustomEmojiLoader::startCacheLookup(
 	});
 	const auto size = FrameSizeFromTag(_tag, _sizeOverride);
 	const auto weak = base::make_weak(&lookup->process->guard);
-	document->owner().cacheBigFile().get(key, [=](QByteArray value) {
+	const auto session = &document->session();
+	ChatHelpers::GetCachedFrames(session, key, [=](QByteArray &&value) {
 		auto cache = Ui::CustomEmoji::Cache::FromSerialized(value, size);
 		crl::on_main(weak, [=, result = std::move(cache)]() mutable {
 			lookupDone(lookup, std::move(result));
@@ -382,7 +384,10 @@ void CustomEmojiLoader::check() {
 	auto put = [=, key = cacheKey(document)](QByteArray value) {
 		const auto size = value.size();
 		if (size <= Storage::kMaxFileInMemory) {
-			document->owner().cacheBigFile().put(key, std::move(value));
+			ChatHelpers::PutCachedFrames(
+				&document->session(),
+				key,
+				std::move(value));
 		} else {
 			LOG(("Data Error: Cached emoji size too big: %1.").arg(size));
 		}
@@ -660,7 +665,8 @@ void CustomEmojiManager::resolve(
 	_resolvers[documentId].emplace(listener);
 	_listeners[listener].emplace(documentId);
 	_pendingForRequest.emplace(documentId);
-	if (!_requestId && _pendingForRequest.size() == 1) {
+	if (_requestsInFlight < kMaxRequestsInFlight
+		&& _pendingForRequest.size() == 1) {
 		crl::on_main(this, [=] { request(); });
 	}
 }
@@ -756,7 +762,8 @@ auto CustomEmojiManager::createLoaderWithSetId(
 		const auto i = SizeIndex(tag);
 		_loaders[i][documentId].push_back(base::make_weak(result));
 		_pendingForRequest.emplace(documentId);
-		if (!_requestId && _pendingForRequest.size() == 1) {
+		if (_requestsInFlight < kMaxRequestsInFlight
+			&& _pendingForRequest.size() == 1) {
 			crl::on_main(this, [=] { request(); });
 		}
 	}
@@ -770,6 +777,17 @@ QString CustomEmojiManager::lookupSetName(uint64 setId) {
 }
 
 void CustomEmojiManager::request() {
+	// A big burst, like opening a chat full of emoji, is sent in several
+	// chunks at once instead of one round-trip after another.
+	while (!_pendingForRequest.empty()
+		&& _requestsInFlight < kMaxRequestsInFlight) {
+		requestChunk();
+	}
+}
+
+void CustomEmojiManager::requestChunk() {
+	Expects(!_pendingForRequest.empty());
+
 	auto ids = QVector<MTPlong>();
 	ids.reserve(std::min(kMaxPerRequest, int(_pendingForRequest.size())));
 	while (!_pendingForRequest.empty() && ids.size() < kMaxPerRequest) {
@@ -777,11 +795,9 @@ void CustomEmojiManager::request() {
 		ids.push_back(MTP_long(*i));
 		_pendingForRequest.erase(i);
 	}
-	if (ids.isEmpty()) {
-		return;
-	}
+	++_requestsInFlight;
 	const auto api = &_owner->session().api();
-	_requestId = api->request(MTPmessages_GetCustomEmojiDocuments(
+	api->request(MTPmessages_GetCustomEmojiDocuments(
 		MTP_vector<MTPlong>(ids)
 	)).done([=](const MTPVector<MTPDocument> &result) {
 		for (const auto &entry : result.v) {
@@ -874,10 +890,8 @@ int CustomEmojiManager::SizeIndex(SizeTag tag) {
 }
 
 void CustomEmojiManager::requestFinished() {
-	_requestId = 0;
-	if (!_pendingForRequest.empty()) {
-		request();
-	}
+	--_requestsInFlight;
+	request();
 }
 
 void CustomEmojiManager::repaintLater(
@@ -128,6 +128,7 @@ private:
 		int sizeOverride = 0);
 
 	void request();
+	void requestChunk();
 	void requestFinished();
 	void repaintLater(
 		not_null<Ui::CustomEmoji::Instance*> instance,
@@ -179,7 +180,7 @@ private:
 		base::flat_set<DocumentId>> _listeners;
 	base::flat_set<DocumentId> _pendingForRequest;
 
-	mtpRequestId _requestId = 0;
+	int _requestsInFlight = 0;
 
 	uint64 _coloredSetId = 0;
 
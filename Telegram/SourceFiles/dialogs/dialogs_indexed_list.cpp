@@ -12,6 +12,34 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 
 namespace Dialogs {
+namespace {
+
+[[nodiscard]] bool AnyStartsWith(
+		const base::flat_set<QString> &names,
+		const QString &word) {
+	// Names are sorted, so all the names starting with the word
+	// go right from the lower bound of the word itself.
+	const auto i = names.lower_bound(word);
+	return (i != names.end()) && i->startsWith(word);
+}
+
+[[nodiscard]] bool NarrowsQuery(
+		const QStringList &words,
+		const QStringList &previous) {
+	// Each row matching 'words' matches 'previous' if every previous
+	// word is a prefix of some of the new words.
+	for (const auto &was : previous) {
+		const auto extended = ranges::any_of(words, [&](const QString &w) {
+			return w.startsWith(was);
+		});
+		if (!extended) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
 
 IndexedList::IndexedList(SortMode sortMode, FilterId filterId)
 : _sortMode(sortMode)
@@ -24,6 +52,7 @@ RowsByLetter IndexedList::addToEnd(Key key) {
 	if (const auto row = _list.getRow(key)) {
 		return { row };
 	}
+	changed();
 
 	auto result = RowsByLetter{ _list.addToEnd(key) };
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
@@ -40,6 +69,7 @@ Row *IndexedList::addByName(Key key) {
 	if (const auto row = _list.getRow(key)) {
 		return row;
 	}
+	changed();
 
 	const auto result = _list.addByName(key);
 	for (const auto &ch : key.entry()->chatListFirstLetters()) {
@@ -53,6 +83,7 @@ Row *IndexedList::addByName(Key key) {
 }
 
 void IndexedList::adjustByDate(const RowsByLetter &links) {
+	changed();
 	_list.adjustByDate(links.main);
 	for (const auto &[ch, row] : links.letters) {
 		if (auto it = _index.find(ch); it != _index.cend()) {
@@ -71,6 +102,7 @@ bool IndexedList::updateHeight(Key key, float64 narrowRatio) {
 
 void IndexedList::moveToTop(Key key) {
 	if (_list.moveToTop(key)) {
+		changed();
 		for (const auto &ch : key.entry()->chatListFirstLetters()) {
 			if (auto it = _index.find(ch); it != _index.cend()) {
 				it->second.moveToTop(key);
@@ -124,6 +156,7 @@ void IndexedList::adjustByName(
 		const base::flat_set<QChar> &oldLetters) {
 	Expects(_sortMode == SortMode::Name);
 
+	changed();
 	const auto mainRow = _list.adjustByName(key);
 	if (!mainRow) return;
 
@@ -163,6 +196,7 @@ void IndexedList::adjustNames(
 	const auto key = Dialogs::Key(history);
 	auto mainRow = _list.getRow(key);
 	if (!mainRow) return;
+	changed();
 
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
@@ -196,6 +230,7 @@ void IndexedList::adjustNames(
 
 void IndexedList::remove(Key key, Row *replacedBy) {
 	if (_list.remove(key, replacedBy)) {
+		changed();
 		for (const auto &ch : key.entry()->chatListFirstLetters()) {
 			if (const auto it = _index.find(ch); it != _index.cend()) {
 				it->second.remove(key, replacedBy);
@@ -205,12 +240,48 @@ void IndexedList::remove(Key key, Row *replacedBy) {
 }
 
 void IndexedList::clear() {
+	changed();
 	_list.clear();
 	_index.clear();
 }
 
+auto IndexedList::filteredCached(const QStringList &words) const
+-> const std::vector<not_null<Row*>>* {
+	const auto &cache = _filteredCache;
+	return (cache.generation == _generation
+		&& !cache.words.isEmpty()
+		&& NarrowsQuery(words, cache.words))
+		? &cache.rows
+		: nullptr;
+}
+
 std::vector<not_null<Row*>> IndexedList::filtered(
 		const QStringList &words) const {
+	const auto matches = [&](not_null<Row*> row) {
+		const auto &nameWords = row->entry()->chatListNameWords();
+		return ranges::all_of(words, [&](const QString &word) {
+			return AnyStartsWith(nameWords, word);
+		});
+	};
+	const auto remember = [&](std::vector<not_null<Row*>> rows) {
+		_filteredCache = FilteredCache{
+			.words = words,
+			.rows = rows,
+			.generation = _generation,
+		};
+		return rows;
+	};
+	if (const auto cached = filteredCached(words)) {
+		auto result = std::vector<not_null<Row*>>();
+		result.reserve(cached->size());
+		for (const auto &row : *cached) {
+			if (matches(row)) {
+				result.push_back(row);
+			}
+		}
+		return remember(std::move(result));
+	}
+
 	const auto minimal = [&]() -> const Dialogs::List* {
 		if (empty()) {
 			return nullptr;
@@ -231,32 +302,15 @@ std::vector<not_null<Row*>> IndexedList::filtered(
 	}();
 	auto result = std::vector<not_null<Row*>>();
 	if (!minimal || minimal->empty()) {
-		return result;
+		return remember(std::move(result));
 	}
 	result.reserve(minimal->size());
 	for (const auto &row : *minimal) {
-		const auto &nameWords = row->entry()->chatListNameWords();
-		const auto found = [&](const QString &word) {
-			for (const auto &name : nameWords) {
-				if (name.startsWith(word)) {
-					return true;
-				}
-			}
-			return false;
-		};
-		const auto allFound = [&] {
-			for (const auto &word : words) {
-				if (!found(word)) {
-					return false;
-				}
-			}
-			return true;
-		}();
-		if (allFound) {
+		if (matches(row)) {
 			result.push_back(row);
 		}
 	}
-	return result;
+	return remember(std::move(result));
 }
 
 } // namespace Dialogs
@@ -85,6 +85,20 @@ public:
 	[[nodiscard]] iterator findByY(int y) { return all().findByY(y); }
 
 private:
+	// Result of the last filtered() call, it is reused while the list
+	// is not changed and the new query only narrows the previous one.
+	struct FilteredCache {
+		QStringList words;
+		std::vector<not_null<Row*>> rows;
+		int generation = -1;
+	};
+
+	void changed() {
+		++_generation;
+	}
+	[[nodiscard]] const std::vector<not_null<Row*>> *filteredCached(
+		const QStringList &words) const;
+
 	void adjustByName(
 		Key key,
 		const base::flat_set<QChar> &oldChars);
@@ -97,6 +111,8 @@ private:
 	FilterId _filterId = 0;
 	List _list, _empty;
 	base::flat_map<QChar, List> _index;
+	int _generation = 0;
+	mutable FilteredCache _filteredCache;
 
 };
 
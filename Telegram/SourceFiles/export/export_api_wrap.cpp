@@ -23,8 +23,6 @@ namespace {
 
 constexpr auto kUserpicsSliceLimit = 100;
 constexpr auto kFileChunkSize = 128 * 1024;
-constexpr auto kFileRequestsCount = 2;
-//constexpr auto kFileNextRequestDelay = crl::time(20);
 constexpr auto kChatsSliceLimit = 100;
 constexpr auto kMessagesSliceLimit = 100;
 constexpr auto kTopPeerSliceLimit = 100;
@@ -178,8 +176,11 @@ struct ApiWrap::FileProcess {
 	struct Request {
 		int64 offset = 0;
 		QByteArray bytes;
+		mtpRequestId requestId = 0;
 	};
 	std::deque<Request> requests;
+
+	// File reference refresh request.
 	mtpRequestId requestId = 0;
 };
 
@@ -218,11 +219,16 @@ struct ApiWrap::ChatProcess {
 	Fn<bool(Data::MessagesSlice&&)> handleSlice;
 	FnMut<void()> done;
 
-	FnMut<void(MTPmessages_Messages&&)> requestDone;
-
 	int localSplitIndex = 0;
 	int32 largestIdPlusOne = 1;
 
+	// Next slice is requested while files of the current one are loading.
+	std::optional<MTPmessages_Messages> prefetched;
+	int prefetchLocalSplitIndex = 0;
+	int32 prefetchOffsetId = 0;
+	bool prefetching = false;
+	bool waitingPrefetch = false;
+
 	Data::ParseMediaContext context;
 	std::optional<Data::MessagesSlice> slice;
 	bool lastSlice = false;
@@ -382,7 +388,12 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int64 offset) {
 			MTP_long(offset),
 			MTP_int(kFileChunkSize))
 	)).fail([=](const MTP::Error &result) {
-		_fileProcess->requestId = 0;
+		using Request = FileProcess::Request;
+		auto &requests = _fileProcess->requests;
+		const auto i = ranges::find(requests, offset, &Request::offset);
+		if (i != end(requests)) {
+			i->requestId = 0;
+		}
 		if (result.type() == u"TAKEOUT_FILE_EMPTY"_q
 			&& _otherDataProcess != nullptr) {
 			filePartDone(
@@ -1273,9 +1284,12 @@ void ApiWrap::skipFile(uint64 randomId) {
 		return;
 	}
 	LOG(("Export Info: File skipped."));
-	Assert(!_fileProcess->requests.empty());
-	Assert(_fileProcess->requestId != 0);
-	_mtp.request(base::take(_fileProcess->requestId)).cancel();
+	Assert(!_fileProcess->requests.empty()
+		|| _fileProcess->requestId != 0);
+	cancelFileParts();
+	if (const auto requestId = base::take(_fileProcess->requestId)) {
+		_mtp.request(requestId).cancel();
+	}
 	base::take(_fileProcess)->done(QString());
 }
 
@@ -1600,6 +1614,19 @@ void ApiWrap::requestMessagesSlice() {
 		loadMessagesFiles({});
 		return;
 	}
+	const auto prefetchMatches = (_chatProcess->prefetchLocalSplitIndex
+			== _chatProcess->localSplitIndex)
+		&& (_chatProcess->prefetchOffsetId
+			== _chatProcess->largestIdPlusOne);
+	if (_chatProcess->prefetching && prefetchMatches) {
+		_chatProcess->waitingPrefetch = true;
+		return;
+	} else if (auto prefetched = base::take(_chatProcess->prefetched)) {
+		if (prefetchMatches) {
+			handleMessagesSlice(*prefetched);
+			return;
+		}
+	}
 	requestChatMessages(
 		_chatProcess->info.splits[_chatProcess->localSplitIndex],
 		_chatProcess->largestIdPlusOne,
@@ -1608,19 +1635,59 @@ void ApiWrap::requestMessagesSlice() {
 		[=](const MTPmessages_Messages &result) {
 		Expects(_chatProcess != nullptr);
 
-		result.match([&](const MTPDmessages_messagesNotModified &data) {
-			error("Unexpected messagesNotModified received.");
-		}, [&](const auto &data) {
-			if constexpr (MTPDmessages_messages::Is<decltype(data)>()) {
-				_chatProcess->lastSlice = true;
-			}
-			loadMessagesFiles(Data::ParseMessagesSlice(
-				_chatProcess->context,
-				data.vmessages(),
-				data.vusers(),
-				data.vchats(),
-				_chatProcess->info.relativePath));
-		});
+		handleMessagesSlice(result);
+	});
+}
+
+void ApiWrap::handleMessagesSlice(const MTPmessages_Messages &result) {
+	Expects(_chatProcess != nullptr);
+
+	result.match([&](const MTPDmessages_messagesNotModified &data) {
+		error("Unexpected messagesNotModified received.");
+	}, [&](const auto &data) {
+		if constexpr (MTPDmessages_messages::Is<decltype(data)>()) {
+			_chatProcess->lastSlice = true;
+		}
+		loadMessagesFiles(Data::ParseMessagesSlice(
+			_chatProcess->context,
+			data.vmessages(),
+			data.vusers(),
+			data.vchats(),
+			_chatProcess->info.relativePath));
+	});
+}
+
+void ApiWrap::prefetchMessagesSlice() {
+	Expects(_chatProcess != nullptr);
+	Expects(_chatProcess->slice.has_value());
+
+	// Raw result is kept, it is parsed only when the slice is used,
+	// because parsing updates _chatProcess->context sequentially.
+	const auto &list = _chatProcess->slice->list;
+	if (_chatProcess->lastSlice
+		|| _chatProcess->prefetching
+		|| _chatProcess->prefetched
+		|| list.empty()) {
+		return;
+	}
+	const auto localSplitIndex = _chatProcess->localSplitIndex;
+	const auto offsetId = list.back().id + 1;
+	_chatProcess->prefetching = true;
+	_chatProcess->prefetchLocalSplitIndex = localSplitIndex;
+	_chatProcess->prefetchOffsetId = offsetId;
+	requestChatMessages(
+		_chatProcess->info.splits[localSplitIndex],
+		offsetId,
+		-kMessagesSliceLimit,
+		kMessagesSliceLimit,
+		[=](const MTPmessages_Messages &result) {
+		Expects(_chatProcess != nullptr);
+
+		_chatProcess->prefetching = false;
+		_chatProcess->prefetched = result;
+		if (base::take(_chatProcess->waitingPrefetch)) {
+			requestMessagesSlice();
+		}
 	});
 }
 
@@ -1632,11 +1699,13 @@ void ApiWrap::requestChatMessages(
 		FnMut<void(MTPmessages_Messages&&)> done) {
 	Expects(_chatProcess != nullptr);
 
-	_chatProcess->requestDone = std::move(done);
+	// Several requests may be sent at once, when a slice is prefetched.
+	const auto requestDone = std::make_shared<
+		FnMut<void(MTPmessages_Messages&&)>>(std::move(done));
 	const auto doneHandler = [=](MTPmessages_Messages &&result) {
 		Expects(_chatProcess != nullptr);
 
-		base::take(_chatProcess->requestDone)(std::move(result));
+		base::take(*requestDone)(std::move(result));
 	};
 	const auto splitsCount = int(_splits.size());
 	const auto realPeerInput = (splitIndex >= 0)
@@ -1689,7 +1758,7 @@ void ApiWrap::requestChatMessages(
 						offsetId,
 						addOffset,
 						limit,
-						base::take(_chatProcess->requestDone));
+						base::take(*requestDone));
 					return true;
 				}
 			}
@@ -1710,6 +1779,7 @@ void ApiWrap::loadMessagesFiles(Data::MessagesSlice &&slice) {
 	_chatProcess->slice = std::move(slice);
 	_chatProcess->fileIndex = 0;
 
+	prefetchMessagesSlice();
 	resolveCustomEmoji();
 }
 
@@ -2120,7 +2190,7 @@ void ApiWrap::loadFile(
 
 	loadFilePart();
 
-	Ensures(_fileProcess->requestId != 0);
+	Ensures(!_fileProcess->requests.empty());
 }
 
 auto ApiWrap::prepareFileProcess(
@@ -2144,36 +2214,52 @@ auto ApiWrap::prepareFileProcess(
 }
 
 void ApiWrap::loadFilePart() {
-	if (!_fileProcess
-		|| _fileProcess->requestId
-		|| _fileProcess->requests.size() >= kFileRequestsCount
-		|| (_fileProcess->size > 0
-			&& _fileProcess->offset >= _fileProcess->size)) {
-		return;
+	// Parts are requested in parallel only when we know the file size,
+	// otherwise we don't know where to stop, so one request at a time.
+	// Files are loaded one by one, so that's the limit for the file dc.
+	const auto limit = _settings->media.requestsPerDc;
+	const auto canRequest = [&] {
+		const auto &process = _fileProcess;
+		return process
+			&& !process->requestId
+			&& (int(process->requests.size()) < limit)
+			&& (process->size > 0 || process->requests.empty())
+			&& (process->size <= 0 || process->offset < process->size);
+	};
+	while (canRequest()) {
+		const auto offset = _fileProcess->offset;
+		_fileProcess->requests.push_back({ offset });
+		const auto requestId = fileRequest(
+			_fileProcess->location,
+			offset
+		).done([=](const MTPupload_File &result) {
+			using Request = FileProcess::Request;
+			auto &requests = _fileProcess->requests;
+			const auto i = ranges::find(requests, offset, &Request::offset);
+			Assert(i != end(requests));
+			i->requestId = 0;
+			filePartDone(offset, result);
+		}).send();
+		if (!_fileProcess) {
+			return;
+		}
+		using Request = FileProcess::Request;
+		auto &requests = _fileProcess->requests;
+		const auto i = ranges::find(requests, offset, &Request::offset);
+		if (i != end(requests)) {
+			i->requestId = requestId;
+		}
+		_fileProcess->offset += kFileChunkSize;
 	}
+}
 
-	const auto offset = _fileProcess->offset;
-	_fileProcess->requests.push_back({ offset });
-	_fileProcess->requestId = fileRequest(
-		_fileProcess->location,
-		_fileProcess->offset
-	).done([=](const MTPupload_File &result) {
-		_fileProcess->requestId = 0;
-		filePartDone(offset, result);
-	}).send();
-	_fileProcess->offset += kFileChunkSize;
+void ApiWrap::cancelFileParts() {
+	Expects(_fileProcess != nullptr);
 
-	if (_fileProcess->size > 0
-		&& _fileProcess->requests.size() < kFileRequestsCount) {
-		// Only one request at a time supported right now.
-		//const auto runner = _runner;
-		//crl::on_main([=] {
-		//	QTimer::singleShot(kFileNextRequestDelay, [=] {
-		//		runner([=] {
-		//			loadFilePart();
-		//		});
-		//	});
-		//});
+	for (auto &request : _fileProcess->requests) {
+		if (const auto requestId = base::take(request.requestId)) {
+			_mtp.request(requestId).cancel();
+		}
 	}
 }
 
@@ -2239,7 +2325,21 @@ void ApiWrap::filePartDone(int64 offset, const MTPupload_File &result) {
 
 void ApiWrap::filePartRefreshReference(int64 offset) {
 	Expects(_fileProcess != nullptr);
-	Expects(_fileProcess->requestId == 0);
+
+	if (_fileProcess->requestId) {
+		// Already refreshing, all the parts will be requested again.
+		return;
+	}
+
+	// Drop all the parts that were not written yet and request them
+	// again after the reference is refreshed, starting from the first.
+	cancelFileParts();
+	auto &requests = _fileProcess->requests;
+	if (!requests.empty()) {
+		offset = std::min(offset, requests.front().offset);
+		requests.clear();
+	}
+	_fileProcess->offset = offset;
 
 	const auto &origin = _fileProcess->origin;
 	if (origin.storyId) {
@@ -2329,13 +2429,7 @@ void ApiWrap::filePartExtractReference(
 					_fileProcess->location,
 					message.thumb().file.location);
 				if (refresh1 || refresh2) {
-					_fileProcess->requestId = fileRequest(
-						_fileProcess->location,
-						offset
-					).done([=](const MTPupload_File &result) {
-						_fileProcess->requestId = 0;
-						filePartDone(offset, result);
-					}).send();
+					loadFilePart();
 					return;
 				}
 			}
@@ -2362,13 +2456,7 @@ void ApiWrap::filePartExtractReference(
 				_fileProcess->location,
 				story.thumb().file.location);
 			if (refresh1 || refresh2) {
-				_fileProcess->requestId = fileRequest(
-					_fileProcess->location,
-					offset
-				).done([=](const MTPupload_File &result) {
-					_fileProcess->requestId = 0;
-					filePartDone(offset, result);
-				}).send();
+				loadFilePart();
 				return;
 			}
 		}
@@ -2378,10 +2466,11 @@ void ApiWrap::filePartExtractReference(
 
 void ApiWrap::filePartUnavailable() {
 	Expects(_fileProcess != nullptr);
-	Expects(!_fileProcess->requests.empty());
 
 	LOG(("Export Error: File unavailable."));
 
+	cancelFileParts();
+
 	base::take(_fileProcess)->done(QString());
 }
 
@@ -173,6 +173,8 @@ private:
 	void checkFirstMessageDate(int localSplitIndex, int count);
 	void messagesCountLoaded(int localSplitIndex, int count);
 	void requestMessagesSlice();
+	void handleMessagesSlice(const MTPmessages_Messages &result);
+	void prefetchMessagesSlice();
 	void requestChatMessages(
 		int splitIndex,
 		int offsetId,
@@ -216,6 +218,7 @@ private:
 		Fn<bool(FileProgress)> progress,
 		FnMut<void(QString)> done);
 	void loadFilePart();
+	void cancelFileParts();
 	void filePartDone(int64 offset, const MTPupload_File &result);
 	void filePartUnavailable();
 	void filePartRefreshReference(int64 offset);
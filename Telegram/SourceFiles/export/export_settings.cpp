@@ -21,6 +21,8 @@ bool MediaSettings::validate() const {
 		return false;
 	} else if (sizeLimit < 0 || sizeLimit > kMaxFileSize) {
 		return false;
+	} else if (requestsPerDc < 1 || requestsPerDc > kMaxRequestsPerDc) {
+		return false;
 	}
 	return true;
 }
@@ -36,6 +36,10 @@ struct MediaSettings {
 	Types types = DefaultTypes();
 	int64 sizeLimit = 8 * 1024 * 1024;
 
+	// File parts requested in parallel from one dc.
+	static constexpr auto kMaxRequestsPerDc = 8;
+	int requestsPerDc = 4;
+
 	static inline Types DefaultTypes() {
 		return Type::Photo;
 	}
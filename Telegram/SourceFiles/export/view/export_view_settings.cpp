@@ -667,6 +667,7 @@ void SettingsWidget::addMediaOptions(
 		tr::lng_export_option_files(tr::now),
 		MediaType::File);
 	addSizeSlider(container);
+	addRequestsSlider(container);
 }
 
 void SettingsWidget::addMediaOption(
@@ -736,6 +737,47 @@ void SettingsWidget::addSizeSlider(
 	}, label->lifetime());
 }
 
+void SettingsWidget::addRequestsSlider(
+		not_null<Ui::VerticalLayout*> container) {
+	using namespace rpl::mappers;
+
+	const auto slider = container->add(
+		object_ptr<Ui::MediaSlider>(container, st::exportFileSizeSlider),
+		st::exportFileSizePadding);
+	slider->resize(st::exportFileSizeSlider.seekSize);
+	slider->setPseudoDiscrete(
+		MediaSettings::kMaxRequestsPerDc,
+		[](int index) { return index + 1; },
+		readData().media.requestsPerDc,
+		[=](int count) {
+			changeData([&](Settings &data) {
+				data.media.requestsPerDc = count;
+			});
+		});
+
+	const auto label = Ui::CreateChild<Ui::LabelSimple>(
+		container.get(),
+		st::exportFileSizeLabel);
+	value() | rpl::map([](const Settings &data) {
+		return data.media.requestsPerDc;
+	}) | rpl::start_with_next([=](int count) {
+		label->setText(tr::lng_export_option_parallel_downloads(
+			tr::now,
+			lt_amount,
+			QString::number(count)));
+	}, slider->lifetime());
+
+	rpl::combine(
+		label->widthValue(),
+		slider->geometryValue(),
+		_2
+	) | rpl::start_with_next([=](QRect geometry) {
+		label->moveToRight(
+			st::exportFileSizePadding.right(),
+			geometry.y() - label->height() - st::exportFileSizeLabelBottom);
+	}, label->lifetime());
+}
+
 void SettingsWidget::refreshButtons(
 		not_null<Ui::RpWidget*> container,
 		bool canStart) {
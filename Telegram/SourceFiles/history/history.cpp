@@ -3043,7 +3043,7 @@ HistoryItem *History::lastEditableMessage() const {
 	return nullptr;
 }
 
-void History::resizeToWidth(int newWidth) {
+void History::resizeToWidth(int newWidth, int exactTop, int exactBottom) {
 	using Request = HistoryBlock::ResizeRequest;
 	const auto request = (_flags & Flag::PendingAllItemsResize)
 		? Request::ReinitAll
@@ -3054,12 +3054,20 @@ void History::resizeToWidth(int newWidth) {
 		return;
 	}
 	_flags &= ~(Flag::HasPendingResizedItems | Flag::PendingAllItemsResize);
+	if (request != Request::ResizePending) {
+		_flags &= ~Flag::HasProvisionalItems;
+	}
 
 	_width = newWidth;
 	int y = 0;
 	for (const auto &block : blocks) {
+		const auto top = block->y();
 		block->setY(y);
-		y += block->resizeGetHeight(newWidth, request);
+		y += block->resizeGetHeight(
+			newWidth,
+			request,
+			exactTop - top,
+			exactBottom - top);
 	}
 	_height = y;
 }
@@ -3069,6 +3077,59 @@ void History::forceFullResize() {
 	_flags |= Flag::HasPendingResizedItems;
 }
 
+bool History::hasProvisionalItems() const {
+	return _flags & Flag::HasProvisionalItems;
+}
+
+bool History::resizeProvisionalItems(int top, int bottom, crl::time till) {
+	if (!hasProvisionalItems()) {
+		return false;
+	}
+	auto resized = false;
+	const auto resize = [&](not_null<Element*> view) {
+		view->resizeGetHeight(_width);
+		resized = true;
+	};
+	for (const auto &block : blocks) {
+		const auto blockTop = block->y();
+		if (blockTop >= bottom) {
+			break;
+		} else if (blockTop + block->height() <= top) {
+			continue;
+		}
+		for (const auto &message : block->messages) {
+			const auto messageTop = blockTop + message->y();
+			if (messageTop >= bottom) {
+				break;
+			} else if (messageTop + message->height() > top
+				&& message->provisionalHeight()) {
+				resize(message.get());
+			}
+		}
+	}
+	const auto finished = [&] {
+		for (const auto &block : ranges::views::reverse(blocks)) {
+			for (const auto &message
+				: ranges::views::reverse(block->messages)) {
+				if (!message->provisionalHeight()) {
+					continue;
+				} else if (crl::now() >= till) {
+					return false;
+				}
+				resize(message.get());
+			}
+		}
+		return true;
+	}();
+	if (finished) {
+		_flags &= ~Flag::HasProvisionalItems;
+	}
+	if (resized) {
+		_flags |= Flag::HasPendingResizedItems;
+	}
+	return resized;
+}
+
 Data::Thread *History::threadFor(MsgId topicRootId) {
 	return topicRootId
 		? peer->forumTopicFor(topicRootId)
@@ -3459,6 +3520,7 @@ void History::clear(ClearType type) {
 			item->destroy();
 		}
 		clearNotifications();
+		session().local().clearHistorySlice(peer->id);
 		owner().notifyHistoryCleared(this);
 		if (unreadCountKnown()) {
 			setUnreadCount(0);
@@ -3611,7 +3673,11 @@ HistoryBlock::HistoryBlock(not_null<History*> history)
 : _history(history) {
 }
 
-int HistoryBlock::resizeGetHeight(int newWidth, ResizeRequest request) {
+int HistoryBlock::resizeGetHeight(
+		int newWidth,
+		ResizeRequest request,
+		int exactTop,
+		int exactBottom) {
 	auto y = 0;
 	if (request == ResizeRequest::ReinitAll) {
 		for (const auto &message : messages) {
@@ -3621,8 +3687,18 @@ int HistoryBlock::resizeGetHeight(int newWidth, ResizeRequest request) {
 		}
 	} else if (request == ResizeRequest::ResizeAll) {
 		for (const auto &message : messages) {
+			const auto top = message->y();
+			const auto exact = message->pendingResize()
+				|| !message->width()
+				|| (top < exactBottom && top + message->height() > exactTop);
 			message->setY(y);
-			y += message->resizeGetHeight(newWidth);
+			if (exact) {
+				y += message->resizeGetHeight(newWidth);
+			} else {
+				message->setProvisionalHeight();
+				_history->_flags |= History::Flag::HasProvisionalItems;
+				y += message->height();
+			}
 		}
 	} else {
 		for (const auto &message : messages) {
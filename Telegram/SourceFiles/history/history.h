@@ -256,8 +256,16 @@ public:
 	MsgId msgIdForRead() const;
 	HistoryItem *lastEditableMessage() const;
 
-	void resizeToWidth(int newWidth);
+	// When resizing all items only the ones intersecting [exactTop,
+	// exactBottom) in the current layout are resized, others keep their
+	// heights as provisional ones until resizeProvisionalItems().
+	void resizeToWidth(int newWidth, int exactTop, int exactBottom);
 	void forceFullResize();
+	[[nodiscard]] bool hasProvisionalItems() const;
+
+	// Resizes provisional items in [top, bottom) and then the rest of
+	// them from the bottom until the deadline, returns true if any was.
+	bool resizeProvisionalItems(int top, int bottom, crl::time till);
 	int height() const;
 
 	void itemRemoved(not_null<HistoryItem*> item);
@@ -432,6 +440,7 @@ private:
 		FakeUnreadWhileOpened = (1 << 4),
 		HasPinnedMessages = (1 << 5),
 		ResolveChatListMessage = (1 << 6),
+		HasProvisionalItems = (1 << 7),
 	};
 	using Flags = base::flags<Flag>;
 	friend inline constexpr auto is_flag_type(Flag) {
@@ -628,7 +637,11 @@ public:
 	void remove(not_null<Element*> view);
 	void refreshView(not_null<Element*> view);
 
-	int resizeGetHeight(int newWidth, ResizeRequest request);
+	int resizeGetHeight(
+		int newWidth,
+		ResizeRequest request,
+		int exactTop,
+		int exactBottom);
 	int y() const {
 		return _y;
 	}
@@ -104,6 +104,8 @@ namespace {
 constexpr auto kScrollDateHideTimeout = 1000;
 constexpr auto kUnloadHeavyPartsPages = 2;
 constexpr auto kClearUserpicsAfter = 50;
+constexpr auto kProvisionalResizeDelay = crl::time(16);
+constexpr auto kProvisionalResizeDuration = crl::time(8);
 
 // Helper binary search for an item in a list that is not completely
 // above the given top of the visible area or below the given bottom of the visible area
@@ -321,10 +323,15 @@ HistoryInner::HistoryInner(
 , _touchSelectTimer([=] { onTouchSelect(); })
 , _touchScrollTimer([=] { onTouchScrollTimer(); })
 , _scrollDateCheck([this] { scrollDateCheck(); })
-, _scrollDateHideTimer([this] { scrollDateHideByTimer(); }) {
+, _scrollDateHideTimer([this] { scrollDateHideByTimer(); })
+, _provisionalResizeTimer([=] {
+	resizeProvisionalItems(crl::now() + kProvisionalResizeDuration);
+}) {
 	_history->delegateMixin()->setCurrent(this);
+	_history->owner().histories().historyShown(_history);
 	if (_migrated) {
 		_migrated->delegateMixin()->setCurrent(this);
+		_migrated->owner().histories().historyShown(_migrated);
 		_migrated->translateTo(_history->translatedTo());
 	}
 
@@ -3267,9 +3274,25 @@ void HistoryInner::recountHistoryGeometry() {
 
 	updateBotInfo(false);
 
-	_history->resizeToWidth(_contentWidth);
+	// Only the items around the visible area are resized right away,
+	// the rest is done in chunks by _provisionalResizeTimer.
+	const auto exactTop = _visibleAreaTop - visibleHeight;
+	const auto exactBottom = _visibleAreaBottom + visibleHeight;
+	const auto migratedWas = migratedTop();
+	const auto historyWas = historyTop();
+	_history->resizeToWidth(
+		_contentWidth,
+		exactTop - historyWas,
+		exactBottom - historyWas);
 	if (_migrated) {
-		_migrated->resizeToWidth(_contentWidth);
+		_migrated->resizeToWidth(
+			_contentWidth,
+			exactTop - migratedWas,
+			exactBottom - migratedWas);
+	}
+	if (_history->hasProvisionalItems()
+		|| (_migrated && _migrated->hasProvisionalItems())) {
+		_provisionalResizeTimer.callOnce(kProvisionalResizeDelay);
 	}
 
 	// With migrated history we perhaps do not need to display
@@ -3333,12 +3356,48 @@ bool HistoryInner::wasSelectedText() const {
 	return _wasSelectedText;
 }
 
+void HistoryInner::resizeProvisionalItems(crl::time till) {
+	auto changed = std::vector<not_null<History*>>();
+	const auto resize = [&](not_null<History*> history, int top) {
+		if (top >= 0
+			&& history->resizeProvisionalItems(
+				_visibleAreaTop - top,
+				_visibleAreaBottom - top,
+				till)) {
+			changed.push_back(history);
+		}
+	};
+	if (_migrated) {
+		resize(_migrated, migratedTop());
+	}
+	resize(_history, historyTop());
+	if (!changed.empty()) {
+		auto &owner = session().data();
+		for (const auto &history : changed) {
+			owner.notifyHistoryChangeDelayed(history);
+		}
+		owner.sendHistoryChangeNotifications();
+	}
+	if (_history->hasProvisionalItems()
+		|| (_migrated && _migrated->hasProvisionalItems())) {
+		if (!_provisionalResizeTimer.isActive()) {
+			_provisionalResizeTimer.callOnce(kProvisionalResizeDelay);
+		}
+	}
+}
+
 void HistoryInner::visibleAreaUpdated(int top, int bottom) {
 	auto scrolledUp = (top < _visibleAreaTop);
 	_visibleAreaTop = top;
 	_visibleAreaBottom = bottom;
 	const auto visibleAreaHeight = bottom - top;
 
+	// Items scrolled into view get their exact heights on the next tick.
+	if (_history->hasProvisionalItems()
+		|| (_migrated && _migrated->hasProvisionalItems())) {
+		_provisionalResizeTimer.callOnce(0);
+	}
+
 	// if history has pending resize events we should not update scrollTopItem
 	if (hasPendingResizedItems()) {
 		return;
@@ -3531,8 +3590,10 @@ HistoryInner::~HistoryInner() {
 		}
 	}
 	_history->delegateMixin()->setCurrent(nullptr);
+	_history->owner().histories().historyHidden(_history);
 	if (_migrated) {
 		_migrated->delegateMixin()->setCurrent(nullptr);
+		_migrated->owner().histories().historyHidden(_migrated);
 	}
 	delete _menu;
 	_mouseAction = MouseAction::None;
@@ -4341,10 +4402,12 @@ void HistoryInner::notifyMigrateUpdated() {
 	if (_migrated != migrated) {
 		if (_migrated) {
 			_migrated->delegateMixin()->setCurrent(nullptr);
+			_migrated->owner().histories().historyHidden(_migrated);
 		}
 		_migrated = migrated;
 		if (_migrated) {
 			_migrated->delegateMixin()->setCurrent(this);
+			_migrated->owner().histories().historyShown(_migrated);
 			_migrated->translateTo(_history->translatedTo());
 		}
 	}
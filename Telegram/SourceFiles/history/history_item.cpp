@@ -397,7 +397,9 @@ HistoryItem::HistoryItem(
 	.shortcutId = data.vquick_reply_shortcut_id().value_or_empty(),
 	.effectId = data.veffect().value_or_empty(),
 }) {
-	_boostsApplied = data.vfrom_boosts_applied().value_or_empty();
+	if (const auto boosts = data.vfrom_boosts_applied().value_or_empty()) {
+		rare().boostsApplied = boosts;
+	}
 
 	// Called only for server-received messages, not locally created ones.
 	applyInitialEffectWatched();
@@ -740,19 +742,30 @@ HistoryItem::HistoryItem(
 	? history->owner().peer(fields.from)
 	: history->peer)
 , _flags(FinalizeMessageFlags(history, fields.flags))
-, _date(fields.date)
-, _shortcutId(fields.shortcutId)
-, _effectId(fields.effectId) {
-	Expects(!_shortcutId
+, _date(fields.date) {
+	if (fields.shortcutId || fields.effectId) {
+		auto &rare = this->rare();
+		rare.shortcutId = fields.shortcutId;
+		rare.effectId = fields.effectId;
+	}
+	Expects(!fields.shortcutId
 		|| isSending()
 		|| _history->owner().shortcutMessages().lookupId(this));
 
 	if (isHistoryEntry() && IsClientMsgId(id)) {
 		_history->registerClientSideMessage(this);
 	}
-	if (_effectId) {
-		_history->owner().reactions().preloadEffectImageFor(_effectId);
+	if (fields.effectId) {
+		_history->owner().reactions().preloadEffectImageFor(
+			fields.effectId);
+	}
+}
+
+HistoryItem::Rare &HistoryItem::rare() {
+	if (!_rare) {
+		_rare = std::make_unique<Rare>();
 	}
+	return *_rare;
 }
 
 HistoryItem::HistoryItem(
@@ -1695,15 +1708,17 @@ bool HistoryItem::isUserpicSuggestion() const {
 }
 
 BusinessShortcutId HistoryItem::shortcutId() const {
-	return _shortcutId;
+	return _rare ? _rare->shortcutId : 0;
 }
 
 bool HistoryItem::isBusinessShortcut() const {
-	return _shortcutId != 0;
+	return shortcutId() != 0;
 }
 
 void HistoryItem::setRealShortcutId(BusinessShortcutId id) {
-	_shortcutId = id;
+	if (id || _rare) {
+		rare().shortcutId = id;
+	}
 }
 
 void HistoryItem::setCustomServiceLink(ClickHandlerPtr link) {
@@ -3150,13 +3165,16 @@ bool HistoryItem::canUpdateDate() const {
 }
 
 void HistoryItem::applyTTL(TimeId destroyAt) {
-	const auto previousDestroyAt = std::exchange(_ttlDestroyAt, destroyAt);
+	const auto previousDestroyAt = ttlDestroyAt();
+	if (destroyAt || _rare) {
+		rare().ttlDestroyAt = destroyAt;
+	}
 	if (previousDestroyAt) {
 		_history->owner().unregisterMessageTTL(previousDestroyAt, this);
 	}
-	if (!_ttlDestroyAt) {
+	if (!destroyAt) {
 		return;
-	} else if (base::unixtime::now() >= _ttlDestroyAt) {
+	} else if (base::unixtime::now() >= destroyAt) {
 		const auto session = &_history->session();
 		crl::on_main(session, [session, id = fullId()]{
 			if (const auto item = session->data().message(id)) {
@@ -3164,7 +3182,7 @@ void HistoryItem::applyTTL(TimeId destroyAt) {
 			}
 		});
 	} else {
-		_history->owner().registerMessageTTL(_ttlDestroyAt, this);
+		_history->owner().registerMessageTTL(destroyAt, this);
 	}
 }
 
@@ -3439,7 +3457,7 @@ MessageGroupId HistoryItem::groupId() const {
 }
 
 EffectId HistoryItem::effectId() const {
-	return _effectId;
+	return _rare ? _rare->effectId : 0;
 }
 
 QString HistoryItem::computeUnavailableReason() const {
@@ -3780,7 +3798,10 @@ void HistoryItem::createComponents(CreateConfig &&config) {
 
 	if (out() && isSending()) {
 		if (const auto channel = _history->peer->asMegagroup()) {
-			_boostsApplied = channel->mgInfo->boostsApplied;
+			const auto boosts = channel->mgInfo->boostsApplied;
+			if (boosts || _rare) {
+				rare().boostsApplied = boosts;
+			}
 		}
 	}
 }
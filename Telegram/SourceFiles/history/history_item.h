@@ -560,11 +560,11 @@ public:
 	[[nodiscard]] bool needsUpdateForVideoQualities(const MTPMessage &data);
 
 	[[nodiscard]] TimeId ttlDestroyAt() const {
-		return _ttlDestroyAt;
+		return _rare ? _rare->ttlDestroyAt : 0;
 	}
 
 	[[nodiscard]] int boostsApplied() const {
-		return _boostsApplied;
+		return _rare ? _rare->boostsApplied : 0;
 	}
 
 	MsgId id;
@@ -679,13 +679,20 @@ private:
 	std::unique_ptr<Data::MessageReactions> _reactions;
 	crl::time _reactionsLastRefreshed = 0;
 
+	// Most of the messages don't have any of those, so they are kept
+	// out of line. Not a RuntimeComponent, UpdateComponents() keeps it.
+	struct Rare {
+		TimeId ttlDestroyAt = 0;
+		int boostsApplied = 0;
+		BusinessShortcutId shortcutId = 0;
+		EffectId effectId = 0;
+	};
+	[[nodiscard]] Rare &rare();
+	std::unique_ptr<Rare> _rare;
+
 	TimeId _date = 0;
-	TimeId _ttlDestroyAt = 0;
-	int _boostsApplied = 0;
-	BusinessShortcutId _shortcutId = 0;
 
 	MessageGroupId _groupId = MessageGroupId();
-	EffectId _effectId = 0;
 	HistoryView::Element *_mainView = nullptr;
 
 	friend class HistoryView::Element;
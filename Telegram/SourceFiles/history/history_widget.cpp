@@ -218,6 +218,59 @@ const auto kPsaAboutPrefix = "cloud_lng_about_psa_";
 	return QString();
 }
 
+[[nodiscard]] MTPVector<MTPUser> UnknownUsers(
+		not_null<Data::Session*> owner,
+		const MTPVector<MTPUser> &users) {
+	auto result = QVector<MTPUser>();
+	for (const auto &user : users.v) {
+		const auto peerId = user.match([](const auto &data) {
+			return peerFromUser(data.vid());
+		});
+		if (!owner->peerLoaded(peerId)) {
+			result.push_back(user);
+		}
+	}
+	return MTP_vector<MTPUser>(std::move(result));
+}
+
+[[nodiscard]] MTPVector<MTPChat> UnknownChats(
+		not_null<Data::Session*> owner,
+		const MTPVector<MTPChat> &chats) {
+	auto result = QVector<MTPChat>();
+	for (const auto &chat : chats.v) {
+		const auto peerId = chat.match([](const MTPDchannel &data) {
+			return peerFromChannel(data.vid());
+		}, [](const MTPDchannelForbidden &data) {
+			return peerFromChannel(data.vid());
+		}, [](const auto &data) {
+			return peerFromChat(data.vid());
+		});
+		if (!owner->peerLoaded(peerId)) {
+			result.push_back(chat);
+		}
+	}
+	return MTP_vector<MTPChat>(std::move(result));
+}
+
+[[nodiscard]] MTPVector<MTPForumTopic> UnknownTopics(
+		not_null<ChannelData*> channel,
+		const MTPVector<MTPForumTopic> &topics) {
+	const auto forum = channel->forum();
+	if (!forum) {
+		return MTP_vector<MTPForumTopic>();
+	}
+	auto result = QVector<MTPForumTopic>();
+	for (const auto &topic : topics.v) {
+		const auto rootId = topic.match([](const auto &data) {
+			return MsgId(data.vid().v);
+		});
+		if (!forum->topicFor(rootId)) {
+			result.push_back(topic);
+		}
+	}
+	return MTP_vector<MTPForumTopic>(std::move(result));
+}
+
 } // namespace
 
 HistoryWidget::HistoryWidget(
@@ -2819,6 +2872,10 @@ void HistoryWidget::clearAllLoadRequests() {
 		histories.cancelRequest(_preloadDownRequest);
 		_preloadDownRequest = 0;
 	}
+	if (_cachedSliceRequest) {
+		histories.cancelRequest(_cachedSliceRequest);
+		_cachedSliceRequest = 0;
+	}
 }
 
 bool HistoryWidget::updateReplaceMediaButton() {
@@ -3677,6 +3734,16 @@ void HistoryWidget::firstLoadMessages() {
 		}
 	}
 
+	// The latest page of a chat is kept in the local history slice cache,
+	// so it can be shown right away and revalidated in the background.
+	const auto latestPage = !offsetId
+		&& !offset
+		&& (from == _history)
+		&& !_migrated;
+	if (latestPage && _history->isEmpty() && showCachedHistorySlice()) {
+		return;
+	}
+
 	const auto offsetDate = 0;
 	const auto maxId = 0;
 	const auto minId = 0;
@@ -3697,6 +3764,11 @@ void HistoryWidget::firstLoadMessages() {
 			MTP_int(minId),
 			MTP_long(historyHash)
 		)).done([=](const MTPmessages_Messages &result) {
+			if (latestPage) {
+				history->session().local().writeHistorySlice(
+					history->peer->id,
+					result);
+			}
 			messagesReceived(history->peer, result, _firstLoadRequest);
 			finish();
 		}).fail([=](const MTP::Error &error) {
@@ -3706,6 +3778,152 @@ void HistoryWidget::firstLoadMessages() {
 	});
 }
 
+bool HistoryWidget::showCachedHistorySlice() {
+	Expects(_history != nullptr);
+
+	const auto history = _history;
+	const auto cached = session().local().readHistorySlice(
+		history->peer->id);
+	if (!cached) {
+		return false;
+	}
+	const auto owner = &history->owner();
+
+	// Cached users, chats and topics may be outdated, apply unknown ones.
+	const auto apply = [&](const auto &data) {
+		owner->processUsers(UnknownUsers(owner, data.vusers()));
+		owner->processChats(UnknownChats(owner, data.vchats()));
+		return data.vmessages().v;
+	};
+	const auto list = cached->match([](
+			const MTPDmessages_messagesNotModified &) {
+		return QVector<MTPMessage>();
+	}, [&](const MTPDmessages_channelMessages &data) {
+		const auto result = apply(data);
+		if (const auto channel = history->peer->asChannel()) {
+			channel->processTopics(UnknownTopics(channel, data.vtopics()));
+		}
+		return result;
+	}, [&](const auto &data) {
+		return apply(data);
+	});
+	if (list.isEmpty()) {
+		return false;
+	}
+	auto cachedIds = std::vector<MsgId>();
+	cachedIds.reserve(list.size());
+	for (const auto &message : list) {
+		cachedIds.push_back(IdFromMessage(message));
+	}
+	addMessagesToFront(history->peer, list);
+	historyLoaded();
+	injectSponsoredMessages();
+
+	const auto offsetId = 0;
+	const auto offsetDate = 0;
+	const auto offset = 0;
+	const auto loadCount = int(list.size());
+	const auto maxId = 0;
+	const auto minId = 0;
+	const auto historyHash = uint64(0);
+
+	const auto type = Data::Histories::RequestType::History;
+	auto &histories = owner->histories();
+	_cachedSliceRequest = histories.sendRequest(history, type, [=](
+			Fn<void()> finish) {
+		return history->session().api().request(MTPmessages_GetHistory(
+			history->peer->input,
+			MTP_int(offsetId),
+			MTP_int(offsetDate),
+			MTP_int(offset),
+			MTP_int(loadCount),
+			MTP_int(maxId),
+			MTP_int(minId),
+			MTP_long(historyHash)
+		)).done([=](const MTPmessages_Messages &result) {
+			_cachedSliceRequest = 0;
+			history->session().local().writeHistorySlice(
+				history->peer->id,
+				result);
+			cachedHistorySliceRevalidated(history, result, cachedIds);
+			finish();
+		}).fail([=] {
+			_cachedSliceRequest = 0;
+			finish();
+		}).send();
+	});
+	return true;
+}
+
+void HistoryWidget::cachedHistorySliceRevalidated(
+		not_null<History*> history,
+		const MTPmessages_Messages &result,
+		const std::vector<MsgId> &cachedIds) {
+	const auto owner = &history->owner();
+	const auto apply = [&](const auto &data) {
+		owner->processUsers(data.vusers());
+		owner->processChats(data.vchats());
+		return data.vmessages().v;
+	};
+	const auto list = result.match([](
+			const MTPDmessages_messagesNotModified &) {
+		return QVector<MTPMessage>();
+	}, [&](const MTPDmessages_channelMessages &data) {
+		if (const auto channel = history->peer->asChannel()) {
+			channel->ptsReceived(data.vpts().v);
+			channel->processTopics(data.vtopics());
+		}
+		return apply(data);
+	}, [&](const auto &data) {
+		return apply(data);
+	});
+
+	// Apply server state over the cached messages: take edits and
+	// drop the messages that were deleted while we were offline.
+	const auto maxCachedId = cachedIds.empty()
+		? MsgId()
+		: *ranges::max_element(cachedIds);
+	auto received = base::flat_set<MsgId>();
+	auto minReceivedId = MsgId();
+	auto newer = QVector<MTPMessage>();
+	for (const auto &message : list) {
+		const auto id = IdFromMessage(message);
+		received.emplace(id);
+		if (!minReceivedId || id < minReceivedId) {
+			minReceivedId = id;
+		}
+		if (id > maxCachedId && !owner->message(history->peer, id)) {
+			newer.push_back(message);
+		} else {
+			owner->updateEditedMessage(message);
+		}
+	}
+	for (const auto id : cachedIds) {
+		if (id >= minReceivedId && !received.contains(id)) {
+			if (const auto item = owner->message(history->peer, id)) {
+				item->destroy();
+			}
+		}
+	}
+
+	// Messages that arrived while we were offline are not in the cache.
+	// If the fresh page overlaps the cached one they can be appended
+	// right away, otherwise there is a gap to load with preload-down.
+	const auto gap = !list.isEmpty() && (minReceivedId > maxCachedId);
+	if (gap) {
+		history->setNotLoadedAtBottom();
+	} else if (!newer.isEmpty()) {
+		if (history == _history) {
+			addMessagesToBack(history->peer, newer);
+		} else {
+			history->addNewerSlice(newer);
+		}
+	}
+	if (history == _history) {
+		preloadHistoryIfNeeded();
+	}
+}
+
 void HistoryWidget::loadMessages() {
 	if (!_history || _preloadRequest) {
 		return;
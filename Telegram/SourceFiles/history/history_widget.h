@@ -577,6 +577,11 @@ private:
 	void messagesReceived(not_null<PeerData*> peer, const MTPmessages_Messages &messages, int requestId);
 	void messagesFailed(const MTP::Error &error, int requestId);
 	void addMessagesToFront(not_null<PeerData*> peer, const QVector<MTPMessage> &messages);
+	bool showCachedHistorySlice();
+	void cachedHistorySliceRevalidated(
+		not_null<History*> history,
+		const MTPmessages_Messages &result,
+		const std::vector<MsgId> &cachedIds);
 	void addMessagesToBack(not_null<PeerData*> peer, const QVector<MTPMessage> &messages);
 
 	void updateSendRestriction();
@@ -733,6 +738,7 @@ private:
 	int _firstLoadRequest = 0; // Not real mtpRequestId.
 	int _preloadRequest = 0; // Not real mtpRequestId.
 	int _preloadDownRequest = 0; // Not real mtpRequestId.
+	int _cachedSliceRequest = 0; // Not real mtpRequestId.
 
 	MsgId _delayedShowAtMsgId = -1;
 	TextWithEntities _delayedShowAtMsgHighlightPart;
@@ -764,6 +764,14 @@ bool Element::pendingResize() const {
 	return _flags & Flag::NeedsResize;
 }
 
+void Element::setProvisionalHeight() {
+	_flags |= Flag::ProvisionalHeight;
+}
+
+bool Element::provisionalHeight() const {
+	return _flags & Flag::ProvisionalHeight;
+}
+
 bool Element::isAttachedToPrevious() const {
 	return _flags & Flag::AttachedToPrevious;
 }
@@ -1383,6 +1391,7 @@ QSize Element::countOptimalSize() {
 }
 
 QSize Element::countCurrentSize(int newWidth) {
+	_flags &= ~Flag::ProvisionalHeight;
 	if (_flags & Flag::NeedsResize) {
 		initDimensions();
 	}
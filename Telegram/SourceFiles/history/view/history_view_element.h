@@ -328,6 +328,7 @@ public:
 		TopicRootReply           = 0x0400,
 		MediaOverriden           = 0x0800,
 		HeavyCustomEmoji         = 0x1000,
+		ProvisionalHeight        = 0x2000,
 	};
 	using Flags = base::flags<Flag>;
 	friend inline constexpr auto is_flag_type(Flag) { return true; }
@@ -359,6 +360,10 @@ public:
 
 	void setPendingResize();
 	[[nodiscard]] bool pendingResize() const;
+
+	// The height is kept from the previous width until the next resize.
+	void setProvisionalHeight();
+	[[nodiscard]] bool provisionalHeight() const;
 	[[nodiscard]] bool isUnderCursor() const;
 
 	[[nodiscard]] bool isLastAndSelfMessage() const;
@@ -86,6 +86,8 @@ constexpr auto kPreloadIfLessThanScreens = 2;
 constexpr auto kPreloadedScreensCountFull
 	= kPreloadedScreensCount + 1 + kPreloadedScreensCount;
 constexpr auto kClearUserpicsAfter = 50;
+constexpr auto kProvisionalResizeDelay = crl::time(16);
+constexpr auto kProvisionalResizeDuration = crl::time(8);
 
 [[nodiscard]] std::unique_ptr<TranslateTracker> MaybeTranslateTracker(
 		History *history) {
@@ -414,6 +416,9 @@ ListWidget::ListWidget(
 	setAttribute(Qt::WA_AcceptTouchEvents);
 	setMouseTracking(true);
 	_scrollDateHideTimer.setCallback([this] { scrollDateHideByTimer(); });
+	_provisionalResizeTimer.setCallback([=] {
+		resizeProvisionalItems(crl::now() + kProvisionalResizeDuration);
+	});
 	_session->data().viewRepaintRequest(
 	) | rpl::start_with_next([this](auto view) {
 		if (view->delegate() == this) {
@@ -1125,6 +1130,11 @@ void ListWidget::visibleTopBottomUpdated(
 		checkUnreadBarCreation();
 	}
 	updateVisibleTopItem();
+
+	// Items scrolled into view get their exact heights on the next tick.
+	if (_provisionalResizeTimer.isActive()) {
+		_provisionalResizeTimer.callOnce(0);
+	}
 	if (scrolledUp) {
 		_scrollDateCheck.call();
 	} else {
@@ -2091,15 +2101,35 @@ void ListWidget::revealItemsCallback() {
 int ListWidget::resizeGetHeight(int newWidth) {
 	update();
 
+	// Only the items around the visible area are resized right away,
+	// the rest is done in chunks by _provisionalResizeTimer.
 	const auto resizeAllItems = (_itemsWidth != newWidth);
+	const auto visibleHeight = (_visibleBottom - _visibleTop);
+	const auto exactTop = _visibleTop - visibleHeight - _itemsTop;
+	const auto exactBottom = _visibleBottom + visibleHeight - _itemsTop;
+	auto provisional = false;
 	auto newHeight = 0;
 	for (const auto &view : _items) {
+		const auto top = view->y();
 		view->setY(newHeight);
-		if (view->pendingResize() || resizeAllItems) {
+		if (view->pendingResize() || !view->width()) {
 			newHeight += view->resizeGetHeight(newWidth);
+		} else if (resizeAllItems) {
+			if (top < exactBottom && top + view->height() > exactTop) {
+				newHeight += view->resizeGetHeight(newWidth);
+			} else {
+				view->setProvisionalHeight();
+				newHeight += view->height();
+			}
 		} else {
 			newHeight += view->height();
 		}
+		provisional = provisional || view->provisionalHeight();
+	}
+	if (!provisional) {
+		_provisionalResizeTimer.cancel();
+	} else if (resizeAllItems || !_provisionalResizeTimer.isActive()) {
+		_provisionalResizeTimer.callOnce(kProvisionalResizeDelay);
 	}
 	if (newHeight > 0) {
 		_itemAverageHeight = std::max(
@@ -2118,6 +2148,34 @@ int ListWidget::resizeGetHeight(int newWidth) {
 	return _itemsTop + _itemsHeight + st::historyPaddingBottom;
 }
 
+void ListWidget::resizeProvisionalItems(crl::time till) {
+	auto resized = false;
+	const auto resize = [&](not_null<Element*> view) {
+		view->resizeGetHeight(_itemsWidth);
+		resized = true;
+	};
+	for (const auto &view : _items) {
+		const auto top = itemTop(view);
+		if (top >= _visibleBottom) {
+			break;
+		} else if (top + view->height() > _visibleTop
+			&& view->provisionalHeight()) {
+			resize(view);
+		}
+	}
+	for (const auto &view : ranges::views::reverse(_items)) {
+		if (!view->provisionalHeight()) {
+			continue;
+		} else if (crl::now() >= till) {
+			break;
+		}
+		resize(view);
+	}
+	if (resized) {
+		updateSize();
+	}
+}
+
 void ListWidget::restoreScrollPosition() {
 	auto newVisibleTop = _visibleTopItem
 		? (itemTop(_visibleTopItem) + _visibleTopFromItem)
@@ -518,13 +518,30 @@ void Controller::show(
 		Prepared page,
 		base::flat_map<QByteArray, rpl::producer<bool>> inChannelValues) {
 	page.script = fillInChannelValuesScript(std::move(inChannelValues));
-	InvokeQueued(_container, [=, page = std::move(page)]() mutable {
-		showInWindow(storageId, std::move(page));
+	const auto url = page.url;
+	_showing[url] = std::move(page);
+	InvokeQueued(_container, [=] {
+		if (auto page = _showing.take(url)) {
+			showInWindow(storageId, std::move(*page));
+		}
 	});
 }
 
-void Controller::update(Prepared page) {
+void Controller::update(
+		Prepared page,
+		base::flat_map<QByteArray, rpl::producer<bool>> inChannelValues) {
+	page.script = fillInChannelValuesScript(std::move(inChannelValues));
+	for (const auto &id : page.channelIds) {
+		if (const auto i = _inChannel.find(id); i != end(_inChannel)) {
+			page.script += toggleInChannelScript(id, i->second);
+		}
+	}
+
 	const auto url = page.url;
+	if (const auto i = _showing.find(url); i != end(_showing)) {
+		i->second = std::move(page);
+		return;
+	}
 	auto i = _indices.find(url);
 	if (i == end(_indices)) {
 		return;
@@ -573,6 +590,7 @@ QByteArray Controller::fillInChannelValuesScript(
 	for (auto &[id, in] : inChannelValues) {
 		if (_inChannelSubscribed.emplace(id).second) {
 			std::move(in) | rpl::start_with_next([=](bool in) {
+				_inChannel[id] = in;
 				if (_ready) {
 					_webview->eval(toggleInChannelScript(id, in));
 				} else {
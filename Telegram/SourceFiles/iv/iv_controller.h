@@ -74,7 +74,9 @@ public:
 		const Webview::StorageId &storageId,
 		Prepared page,
 		base::flat_map<QByteArray, rpl::producer<bool>> inChannelValues);
-	void update(Prepared page);
+	void update(
+		Prepared page,
+		base::flat_map<QByteArray, rpl::producer<bool>> inChannelValues);
 
 	[[nodiscard]] static bool IsGoodTonSiteUrl(const QString &uri);
 	void showTonSite(const Webview::StorageId &storageId, QString uri);
@@ -145,6 +147,7 @@ private:
 	std::unique_ptr<Webview::Window> _webview;
 	rpl::event_stream<Webview::DataRequest> _dataRequests;
 	rpl::event_stream<Event> _events;
+	base::flat_map<QByteArray, bool> _inChannel;
 	base::flat_map<QByteArray, bool> _inChannelChanged;
 	base::flat_set<QByteArray> _inChannelSubscribed;
 	SingleQueuedInvokation _updateStyles;
@@ -164,6 +167,7 @@ private:
 
 	std::vector<Prepared> _pages;
 	base::flat_map<QString, int> _indices;
+	base::flat_map<QString, Prepared> _showing;
 	QString _navigateToHashWhenReady;
 	int _navigateToIndexWhenReady = -1;
 
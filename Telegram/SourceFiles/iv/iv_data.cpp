@@ -79,7 +79,7 @@ void Data::updateCachedViews(int cachedViews) {
 
 void Data::prepare(const Options &options, Fn<void(Prepared)> done) const {
 	crl::async([source = *_source, options, done = std::move(done)] {
-		done(Prepare(source, options));
+		Prepare(source, options, done);
 	});
 }
 
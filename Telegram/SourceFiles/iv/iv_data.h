@@ -12,6 +12,7 @@ namespace Iv {
 struct Source;
 
 struct Options {
+	bool progressive = false;
 };
 
 struct Prepared {
@@ -26,6 +27,7 @@ struct Prepared {
 	bool rtl = false;
 	bool hasCode = false;
 	bool hasEmbeds = false;
+	bool chunk = false; // Only the first blocks, the whole page follows.
 };
 
 struct Geo {
@@ -47,6 +49,7 @@ public:
 
 	void updateCachedViews(int cachedViews);
 
+	// With options.progressive done() may be called twice.
 	void prepare(const Options &options, Fn<void(Prepared)> done) const;
 
 private:
@@ -158,6 +158,7 @@ private:
 	base::flat_map<DocumentId, FileLoad> _files;
 	base::flat_map<QByteArray, rpl::producer<bool>> _inChannelValues;
 
+	int _prepareRequest = 0;
 	bool _preparing = false;
 
 	base::flat_map<QByteArray, QByteArray> _embeds;
@@ -220,17 +221,28 @@ void Shown::prepare(not_null<Data*> data, const QString &hash) {
 
 	_preparing = true;
 	const auto id = _id = data->id();
-	data->prepare({}, [=](Prepared result) {
+	const auto request = ++_prepareRequest;
+
+	// The first chunk may not contain the anchor we should scroll to.
+	const auto progressive = hash.isEmpty();
+	data->prepare({ .progressive = progressive }, [=](Prepared result) {
 		result.hash = hash;
 		crl::on_main(weak, [=, result = std::move(result)]() mutable {
 			result.url = id;
-			if (_id != id || !_preparing) {
+			if (_prepareRequest != request) {
 				return;
 			}
-			_preparing = false;
 			fillChannelJoinedValues(result);
 			fillEmbeds(std::move(result.embeds));
-			showWindowed(std::move(result));
+			if (_preparing) {
+				_preparing = false;
+				showWindowed(std::move(result));
+			} else if (_controller) {
+				// The whole page after the first chunk was shown.
+				_controller->update(
+					std::move(result),
+					base::duplicate(_inChannelValues));
+			}
 		});
 	});
 }
@@ -760,7 +772,9 @@ void Shown::update(not_null<Data*> data) {
 			fillChannelJoinedValues(result);
 			fillEmbeds(std::move(result.embeds));
 			if (_controller) {
-				_controller->update(std::move(result));
+				_controller->update(
+					std::move(result),
+					base::duplicate(_inChannelValues));
 			}
 		});
 	});
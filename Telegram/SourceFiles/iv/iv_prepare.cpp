@@ -21,6 +21,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Iv {
 namespace {
 
+// Long pages are shown after this much of the content is serialized.
+constexpr auto kFirstChunkSize = 16 * 1024;
+
 struct Attribute {
 	QByteArray name;
 	std::optional<QByteArray> value;
@@ -75,9 +78,13 @@ class Parser final {
 public:
 	Parser(const Source &source, const Options &options);
 
-	[[nodiscard]] Prepared result();
+	void serialize(
+		const MTPVector<MTPPageBlock> &blocks,
+		Fn<void(Prepared)> done);
 
 private:
+	[[nodiscard]] Prepared result(const QByteArray &content) const;
+
 	void process(const Source &source);
 	void process(const MTPPhoto &photo);
 	void process(const MTPDocument &document);
@@ -142,7 +149,9 @@ private:
 	[[nodiscard]] QByteArray block(
 		const MTPDpageListOrderedItemBlocks &data);
 
-	[[nodiscard]] QByteArray wrap(const QByteArray &content, int views);
+	[[nodiscard]] QByteArray wrap(
+		const QByteArray &content,
+		int views) const;
 
 	[[nodiscard]] QByteArray tag(
 		const QByteArray &name,
@@ -178,8 +187,9 @@ private:
 	[[nodiscard]] QSize computeSlideshowDimensions(
 		const QVector<MTPPageBlock> &items);
 
-	//const Options _options;
+	const Options _options;
 	const QByteArray _fileOriginPostfix;
+	int _views = 0;
 
 	base::flat_set<QByteArray> _resources;
 
@@ -222,22 +232,45 @@ private:
 }
 
 Parser::Parser(const Source &source, const Options &options)
-: /*_options(options)
-, */_fileOriginPostfix('/' + Number(source.pageId)) {
+: _options(options)
+, _fileOriginPostfix('/' + Number(source.pageId))
+, _views(std::max(
+	source.page.data().vviews().value_or_empty(),
+	source.updatedCachedViews)) {
 	process(source);
 	_result.pageId = source.pageId;
 	_result.name = source.name;
 	_result.rtl = source.page.data().is_rtl();
+}
 
-	const auto views = std::max(
-		source.page.data().vviews().value_or_empty(),
-		source.updatedCachedViews);
-	const auto content = list(source.page.data().vblocks());
-	_result.content = wrap(content, views);
+void Parser::serialize(
+		const MTPVector<MTPPageBlock> &blocks,
+		Fn<void(Prepared)> done) {
+	auto list = QByteArrayList();
+	list.reserve(blocks.v.size());
+	auto size = 0;
+	auto chunk = _options.progressive;
+	for (const auto &item : blocks.v) {
+		list.append(item.match([&](const auto &data) {
+			return block(data);
+		}));
+		size += list.back().size();
+		if (chunk
+			&& size >= kFirstChunkSize
+			&& list.size() < blocks.v.size()) {
+			chunk = false;
+			auto first = result(list.join(QByteArray()));
+			first.chunk = true;
+			done(std::move(first));
+		}
+	}
+	done(result(list.join(QByteArray())));
 }
 
-Prepared Parser::result() {
-	return _result;
+Prepared Parser::result(const QByteArray &content) const {
+	auto result = _result;
+	result.content = wrap(content, _views);
+	return result;
 }
 
 void Parser::process(const Source &source) {
@@ -516,7 +549,6 @@ QByteArray Parser::block(
 		{ "style", style } });
 	const auto minithumb = Images::ExpandInlineBytes(photo.minithumbnail);
 	if (!minithumb.isEmpty()) {
-		const auto image = Images::Read({ .content = minithumb });
 		inner = tag("div", {
 			{ "class", "photo-bg" },
 			{ "style", "background-image:url('data:image/jpeg;base64,"
@@ -567,7 +599,6 @@ QByteArray Parser::block(
 	});
 	const auto minithumb = Images::ExpandInlineBytes(video.minithumbnail);
 	if (!minithumb.isEmpty()) {
-		const auto image = Images::Read({ .content = minithumb });
 		inner = tag("div", {
 			{ "class", "video-bg" },
 			{ "style", "background-image:url('data:image/jpeg;base64,"
@@ -848,6 +879,7 @@ QByteArray Parser::block(const MTPDpageBlockMap &data) {
 	const auto height = std::min(450, (data.vh().v * width / data.vw().v));
 	return tag("figure", tag("img", {
 		{ "src", mapUrl(geo, width, height, data.vzoom().v) },
+		{ "loading", "lazy" },
 	}) + caption(data.vcaption()));
 }
 
@@ -963,7 +995,7 @@ QByteArray Parser::utf(const tl::conditional<MTPstring> &text) {
 	return text ? utf(*text) : QByteArray();
 }
 
-QByteArray Parser::wrap(const QByteArray &content, int views) {
+QByteArray Parser::wrap(const QByteArray &content, int views) const {
 	const auto sep = " \xE2\x80\xA2 ";
 	const auto viewsText = views
 		? (tr::lng_stories_views(tr::now, lt_count_decimal, views) + sep)
@@ -1039,6 +1071,7 @@ QByteArray Parser::rich(const MTPRichText &text) {
 		auto attributes = Attributes{
 			{ "class", "pic" },
 			{ "src", documentFullUrl(image) },
+			{ "loading", "lazy" },
 		};
 		if (const auto width = data.vw().v) {
 			attributes.push_back({ "width", Number(width) });
@@ -1288,9 +1321,12 @@ QSize Parser::computeSlideshowDimensions(
 
 } // namespace
 
-Prepared Prepare(const Source &source, const Options &options) {
+void Prepare(
+		const Source &source,
+		const Options &options,
+		Fn<void(Prepared)> done) {
 	auto parser = Parser(source, options);
-	return parser.result();
+	parser.serialize(source.page.data().vblocks(), std::move(done));
 }
 
 } // namespace Iv
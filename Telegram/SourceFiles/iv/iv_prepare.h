@@ -21,6 +21,9 @@ struct Source {
 	int updatedCachedViews = 0;
 };
 
-[[nodiscard]] Prepared Prepare(const Source &source, const Options &options);
+void Prepare(
+	const Source &source,
+	const Options &options,
+	Fn<void(Prepared)> done);
 
 } // namespace Iv
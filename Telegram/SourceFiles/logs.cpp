@@ -12,9 +12,16 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/launcher.h"
 #include "mtproto/facade.h"
 
+#include <thread>
+#include <condition_variable>
+
 namespace {
 
+// Debug entries are dropped while this much is waiting to be written.
+constexpr auto kQueuedDebugEntriesLimit = 16 * 1024 * 1024;
+
 std::atomic<int> ThreadCounter/* = 0*/;
+std::atomic<int> EntryCounter/* = 0*/;
 thread_local bool WritingEntryFlag/* = false*/;
 
 class WritingEntryScope final {
@@ -61,13 +68,22 @@ QString _logsFilePath(LogDataType type, const QString &postfix = QString()) {
 }
 
 int32 LogsStartIndexChosen = -1;
-QString _logsEntryStart() {
+int _logsThreadId() {
 	static thread_local auto threadId = ThreadCounter++;
-	static auto index = 0;
+	return threadId;
+}
+
+QString _logsEntryStart(int threadId, int index, qint64 time) {
+	const auto tm = QDateTime::fromMSecsSinceEpoch(time);
 
-	const auto tm = QDateTime::currentDateTime();
+	return QString("[%1 %2-%3]").arg(tm.toString("hh:mm:ss.zzz"), QString("%1").arg(threadId, 2, 10, QChar('0'))).arg(index, 7, 10, QChar('0'));
+}
 
-	return QString("[%1 %2-%3]").arg(tm.toString("hh:mm:ss.zzz"), QString("%1").arg(threadId, 2, 10, QChar('0'))).arg(++index, 7, 10, QChar('0'));
+QString _logsEntryStart() {
+	return _logsEntryStart(
+		_logsThreadId(),
+		++EntryCounter,
+		QDateTime::currentMSecsSinceEpoch());
 }
 
 class LogsDataFields {
@@ -111,6 +127,10 @@ public:
 	}
 
 	void write(LogDataType type, const QString &msg) {
+		write(type, msg.toUtf8());
+	}
+
+	void write(LogDataType type, const QByteArray &utf8) {
 		QMutexLocker lock(_logsMutex(type));
 		WritingEntryScope scope;
 
@@ -121,7 +141,7 @@ public:
 		if (!file || !file->isOpen()) {
 			return;
 		}
-		file->write(msg.toUtf8());
+		file->write(utf8);
 		file->flush();
 	}
 
@@ -253,6 +273,118 @@ NEW LOGGING INSTANCE STARTED!!!\n\
 
 LogsDataFields *LogsData = 0;
 
+// Debug, tcp and mtp entries are formatted and written on a separate
+// thread, the caller only stores the text with a binary timestamp.
+class LogsAsyncWriter final {
+public:
+	explicit LogsAsyncWriter(not_null<LogsDataFields*> data)
+	: _data(data)
+	, _thread([=] { run(); }) {
+	}
+
+	~LogsAsyncWriter() {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_finished = true;
+		}
+		_variable.notify_one();
+		_thread.join();
+	}
+
+	void push(LogDataType type, QString &&text) {
+		const auto size = int64(text.size()) * int64(sizeof(QChar));
+		auto entry = Entry{
+			.text = std::move(text),
+			.time = QDateTime::currentMSecsSinceEpoch(),
+			.type = type,
+			.thread = _logsThreadId(),
+			.index = ++EntryCounter,
+		};
+		auto wake = false;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (_size + size > kQueuedDebugEntriesLimit) {
+				++_dropped[type];
+				return;
+			}
+			_size += size;
+			wake = _entries.empty();
+			_entries.push_back(std::move(entry));
+		}
+		if (wake) {
+			_variable.notify_one();
+		}
+	}
+
+private:
+	struct Entry {
+		QString text;
+		qint64 time = 0;
+		LogDataType type = LogDataDebug;
+		int thread = 0;
+		int index = 0;
+	};
+
+	void run() {
+		auto entries = std::vector<Entry>();
+		auto dropped = std::array<int, LogDataCount>();
+		auto finished = false;
+		while (!finished) {
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_variable.wait(lock, [&] {
+					return _finished || !_entries.empty();
+				});
+				std::swap(entries, _entries);
+				dropped = base::take(_dropped);
+				_size = 0;
+				finished = _finished;
+			}
+			write(entries, dropped);
+			entries.clear();
+		}
+	}
+
+	void write(
+			const std::vector<Entry> &entries,
+			const std::array<int, LogDataCount> &dropped) {
+		auto buffers = std::array<QByteArray, LogDataCount>();
+		for (const auto &entry : entries) {
+			auto &buffer = buffers[entry.type];
+			buffer.append(_logsEntryStart(
+				entry.thread,
+				entry.index,
+				entry.time).toUtf8());
+			buffer.append(' ');
+			buffer.append(entry.text.toUtf8());
+			buffer.append('\n');
+		}
+		for (auto type = 0; type != LogDataCount; ++type) {
+			if (dropped[type]) {
+				buffers[type].append(u"%1 %2 entries dropped, queue is full.\n"_q
+					.arg(_logsEntryStart())
+					.arg(dropped[type])
+					.toUtf8());
+			}
+			if (!buffers[type].isEmpty()) {
+				_data->write(LogDataType(type), buffers[type]);
+			}
+		}
+	}
+
+	const not_null<LogsDataFields*> _data;
+	std::mutex _mutex;
+	std::condition_variable _variable;
+	std::vector<Entry> _entries;
+	std::array<int, LogDataCount> _dropped = { { 0 } };
+	int64 _size = 0;
+	bool _finished = false;
+	std::thread _thread;
+
+};
+
+LogsAsyncWriter *LogsWriter = nullptr;
+
 using LogsInMemoryList = QList<QPair<LogDataType, QString>>;
 LogsInMemoryList *LogsInMemory = 0;
 LogsInMemoryList *DeletedLogsInMemory = SharedMemoryLocation<LogsInMemoryList, 0>();
@@ -274,6 +406,14 @@ void _logsWrite(LogDataType type, const QString &msg) {
 	}
 }
 
+void _logsWriteEntry(LogDataType type, QString &&text) {
+	if (LogsWriter && Logs::DebugEnabled()) {
+		LogsWriter->push(type, std::move(text));
+	} else {
+		_logsWrite(type, QString("%1 %2\n").arg(_logsEntryStart(), text));
+	}
+}
+
 namespace Logs {
 namespace {
 
@@ -420,6 +560,9 @@ void start() {
 }
 
 void finish() {
+	delete LogsWriter;
+	LogsWriter = nullptr;
+
 	delete LogsData;
 	LogsData = 0;
 
@@ -464,6 +607,8 @@ bool instanceChecked() {
 	}
 	LogsInMemory = DeletedLogsInMemory;
 
+	LogsWriter = new LogsAsyncWriter(LogsData);
+
 	DEBUG_LOG(("Debug logs started."));
 	LogsBeforeSingleInstanceChecked.clear();
 	return true;
@@ -508,8 +653,7 @@ void writeMain(const QString &v) {
 }
 
 void writeDebug(const QString &v) {
-	const auto msg = QString("%1 %2\n").arg(_logsEntryStart(), v);
-	_logsWrite(LogDataDebug, msg);
+	_logsWriteEntry(LogDataDebug, QString(v));
 
 #ifdef Q_OS_WIN
 	//OutputDebugString(reinterpret_cast<const wchar_t *>(msg.utf16()));
@@ -521,8 +665,7 @@ void writeDebug(const QString &v) {
 }
 
 void writeTcp(const QString &v) {
-	const auto msg = QString("%1 %2\n").arg(_logsEntryStart(), v);
-	_logsWrite(LogDataTcp, msg);
+	_logsWriteEntry(LogDataTcp, QString(v));
 }
 
 void writeMtp(int32 dc, const QString &v) {
@@ -559,11 +702,7 @@ void writeMtp(int32 dc, const QString &v) {
 		}
 		return base + "_unknown" + QString::number(shift);
 	}();
-	const auto msg = _logsEntryStart()
-		+ u" (dc:%1) "_q.arg(expanded)
-		+ v
-		+ '\n';
-	_logsWrite(LogDataMtp, msg);
+	_logsWriteEntry(LogDataMtp, u"(dc:%1) "_q.arg(expanded) + v);
 }
 
 QString full() {
@@ -1547,7 +1547,6 @@ public:
 		const auto samplesCount = samplesFrequency() * duration() / 1000;
 		int64 countbytes = sampleSize() * samplesCount;
 		int64 processed = 0;
-		int64 sumbytes = 0;
 		if (samplesCount < Media::Player::kWaveformSamplesCount) {
 			return false;
 		}
@@ -1556,15 +1555,12 @@ public:
 		peaks.reserve(Media::Player::kWaveformSamplesCount);
 
 		auto fmt = format();
-		auto peak = uint16(0);
-		auto callback = [&](uint16 sample) {
-			accumulate_max(peak, sample);
-			sumbytes += Media::Player::kWaveformSamplesCount;
-			if (sumbytes >= countbytes) {
-				sumbytes -= countbytes;
-				peaks.push_back(peak);
-				peak = 0;
-			}
+		auto state = Media::Audio::PeaksAccumulator{
+			.step = Media::Player::kWaveformSamplesCount,
+			.limit = countbytes,
+		};
+		auto callback = [&](uint16 peak) {
+			peaks.push_back(peak);
 		};
 		while (processed < countbytes) {
 			const auto result = readMore();
@@ -1579,14 +1575,20 @@ public:
 			const auto sampleBytes = v::get<bytes::const_span>(result);
 			Assert(!sampleBytes.empty());
 			if (fmt == AL_FORMAT_MONO8 || fmt == AL_FORMAT_STEREO8) {
-				Media::Audio::IterateSamples<uchar>(sampleBytes, callback);
+				Media::Audio::AccumulatePeaks<uchar>(
+					sampleBytes,
+					state,
+					callback);
 			} else if (fmt == AL_FORMAT_MONO16 || fmt == AL_FORMAT_STEREO16) {
-				Media::Audio::IterateSamples<int16>(sampleBytes, callback);
+				Media::Audio::AccumulatePeaks<int16>(
+					sampleBytes,
+					state,
+					callback);
 			}
 			processed += sampleBytes.size();
 		}
-		if (sumbytes > 0 && peaks.size() < Media::Player::kWaveformSamplesCount) {
-			peaks.push_back(peak);
+		if (state.sum > 0 && peaks.size() < Media::Player::kWaveformSamplesCount) {
+			peaks.push_back(state.peak);
 		}
 
 		if (peaks.isEmpty()) {
@@ -1594,7 +1596,7 @@ public:
 		}
 
 		auto sum = std::accumulate(peaks.cbegin(), peaks.cend(), 0LL);
-		peak = qMax(int32(sum * 1.8 / peaks.size()), 2500);
+		const auto peak = uint16(qMax(int32(sum * 1.8 / peaks.size()), 2500));
 
 		result.resize(peaks.size());
 		for (int32 i = 0, l = peaks.size(); i != l; ++i) {
@@ -410,15 +410,57 @@ TG_FORCE_INLINE uint16 ReadOneSample(int16 data) {
 	return qAbs(data);
 }
 
+// A plain loop without calls or branches inside, so that the compiler
+// vectorizes it (SSE2 / NEON unsigned max of the absolute values).
+template <typename SampleType>
+[[nodiscard]] uint16 MaxSample(const SampleType *from, const SampleType *till) {
+	auto result = uint16(0);
+	for (; from != till; ++from) {
+		result = std::max(result, ReadOneSample(*from));
+	}
+	return result;
+}
+
+// Peak of each group of samples, the group ends when the sum of 'step'
+// added for each sample reaches 'limit'.
+struct PeaksAccumulator {
+	int64 step = 1;
+	int64 limit = 0;
+	int64 sum = 0;
+	uint16 peak = 0;
+};
+
 template <typename SampleType, typename Callback>
-void IterateSamples(bytes::const_span bytes, Callback &&callback) {
-	auto samplesPointer = reinterpret_cast<const SampleType*>(bytes.data());
-	auto samplesCount = bytes.size() / sizeof(SampleType);
-	auto samplesData = gsl::make_span(samplesPointer, samplesCount);
-	for (auto sampleData : samplesData) {
-		callback(ReadOneSample(sampleData));
+void AccumulatePeaks(
+		const SampleType *from,
+		const SampleType *till,
+		PeaksAccumulator &state,
+		Callback &&callback) {
+	Expects(state.step > 0 && state.step <= state.limit);
+
+	while (from != till) {
+		const auto left = (state.limit - state.sum + state.step - 1)
+			/ state.step;
+		const auto count = std::min(int64(till - from), left);
+		accumulate_max(state.peak, MaxSample(from, from + count));
+		from += count;
+		state.sum += count * state.step;
+		if (state.sum >= state.limit) {
+			state.sum -= state.limit;
+			callback(std::exchange(state.peak, uint16(0)));
+		}
 	}
 }
 
+template <typename SampleType, typename Callback>
+void AccumulatePeaks(
+		bytes::const_span bytes,
+		PeaksAccumulator &state,
+		Callback &&callback) {
+	const auto from = reinterpret_cast<const SampleType*>(bytes.data());
+	const auto count = bytes.size() / sizeof(SampleType);
+	AccumulatePeaks(from, from + count, state, callback);
+}
+
 } // namespace Audio
 } // namespace Media
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/audio/media_audio_capture.h"
 
 #include "media/audio/media_audio_capture_common.h"
+#include "media/audio/media_audio.h"
 #include "media/audio/media_audio_ffmpeg_loader.h"
 #include "media/audio/media_audio_track.h"
 #include "ffmpeg/ffmpeg_utility.h"
@@ -236,9 +237,9 @@ struct Instance::Inner::Private {
 	QByteArray data;
 	int32 dataPos = 0;
 
-	int64 waveformMod = 0;
-	int64 waveformEach = (kCaptureFrequency / 100);
-	uint16 waveformPeak = 0;
+	Audio::PeaksAccumulator waveformPeaks = {
+		.limit = (kCaptureFrequency / 100),
+	};
 	QVector<uchar> waveform;
 
 	static int ReadData(void *opaque, uint8_t *buf, int buf_size) {
@@ -523,8 +524,8 @@ void Instance::Inner::stop(Fn<void(Result&&)> callback) {
 			d->fullSamples = 0;
 			d->dataPos = 0;
 			d->data.clear();
-			d->waveformMod = 0;
-			d->waveformPeak = 0;
+			d->waveformPeaks.sum = 0;
+			d->waveformPeaks.peak = 0;
 			d->waveform.clear();
 		} else {
 			float64 coef = 1. / fadeSamples, fadedFrom = 0;
@@ -550,8 +551,8 @@ void Instance::Inner::stop(Fn<void(Result&&)> callback) {
 				d->fullSamples = 0;
 				d->dataPos = 0;
 				d->data.clear();
-				d->waveformMod = 0;
-				d->waveformPeak = 0;
+				d->waveformPeaks.sum = 0;
+				d->waveformPeaks.peak = 0;
 				d->waveform.clear();
 			}
 		}
@@ -621,8 +622,8 @@ void Instance::Inner::stop(Fn<void(Result&&)> callback) {
 		d->dataPos = 0;
 		d->data.clear();
 
-		d->waveformMod = 0;
-		d->waveformPeak = 0;
+		d->waveformPeaks.sum = 0;
+		d->waveformPeaks.peak = 0;
 		d->waveform.clear();
 	}
 
@@ -748,18 +749,12 @@ bool Instance::Inner::processFrame(int32 offset, int32 framesize) {
 		}
 	}
 
-	d->waveform.reserve(d->waveform.size() + (samplesCnt / d->waveformEach) + 1);
-	for (short *ptr = srcSamplesDataChannel, *end = ptr + samplesCnt; ptr != end; ++ptr) {
-		uint16 value = qAbs(*ptr);
-		if (d->waveformPeak < value) {
-			d->waveformPeak = value;
-		}
-		if (++d->waveformMod == d->waveformEach) {
-			d->waveformMod -= d->waveformEach;
-			d->waveform.push_back(uchar(d->waveformPeak / 256));
-			d->waveformPeak = 0;
-		}
-	}
+	d->waveform.reserve(d->waveform.size() + (samplesCnt / d->waveformPeaks.limit) + 1);
+	Audio::AccumulatePeaks(
+		srcSamplesDataChannel,
+		srcSamplesDataChannel + samplesCnt,
+		d->waveformPeaks,
+		[&](uint16 peak) { d->waveform.push_back(uchar(peak / 256)); });
 
 	// Convert to final format
 
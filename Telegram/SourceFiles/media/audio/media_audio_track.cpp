@@ -63,20 +63,16 @@ void Track::fillFromData(bytes::vector &&data) {
 	const auto samplesCount = (loader.duration() * loader.samplesFrequency()) / 1000;
 	const auto peaksCount = _peakEachPosition ? (samplesCount / _peakEachPosition) : 0;
 	_peaks.reserve(peaksCount);
-	auto peakValue = uint16(0);
-	auto peakSamples = 0;
 	auto peakEachSample = (format == AL_FORMAT_STEREO8 || format == AL_FORMAT_STEREO16) ? (_peakEachPosition * 2) : _peakEachPosition;
+	auto peakState = Media::Audio::PeaksAccumulator{
+		.limit = peakEachSample,
+	};
 	_peakValueMin = 0x7FFF;
 	_peakValueMax = 0;
-	auto peakCallback = [this, &peakValue, &peakSamples, peakEachSample](uint16 sample) {
-		accumulate_max(peakValue, sample);
-		if (++peakSamples >= peakEachSample) {
-			peakSamples -= peakEachSample;
-			_peaks.push_back(peakValue);
-			accumulate_max(_peakValueMax, peakValue);
-			accumulate_min(_peakValueMin, peakValue);
-			peakValue = 0;
-		}
+	auto peakCallback = [this](uint16 peakValue) {
+		_peaks.push_back(peakValue);
+		accumulate_max(_peakValueMax, peakValue);
+		accumulate_min(_peakValueMin, peakValue);
 	};
 	do {
 		using Error = AudioPlayerLoader::ReadError;
@@ -98,9 +94,15 @@ void Track::fillFromData(bytes::vector &&data) {
 		_samples.insert(_samples.end(), sampleBytes.data(), sampleBytes.data() + sampleBytes.size());
 		if (peaksCount) {
 			if (format == AL_FORMAT_MONO8 || format == AL_FORMAT_STEREO8) {
-				Media::Audio::IterateSamples<uchar>(sampleBytes, peakCallback);
+				Media::Audio::AccumulatePeaks<uchar>(
+					sampleBytes,
+					peakState,
+					peakCallback);
 			} else if (format == AL_FORMAT_MONO16 || format == AL_FORMAT_STEREO16) {
-				Media::Audio::IterateSamples<int16>(sampleBytes, peakCallback);
+				Media::Audio::AccumulatePeaks<int16>(
+					sampleBytes,
+					peakState,
+					peakCallback);
 			}
 		}
 	} while (true);
@@ -33,10 +33,22 @@ namespace Media {
 namespace Clip {
 namespace {
 
-constexpr auto kClipThreadsCount = 8;
+constexpr auto kClipThreadsCountMin = 2;
+constexpr auto kClipThreadsCountMax = 32;
 constexpr auto kAverageGifSize = 320 * 240;
 constexpr auto kWaitBeforeGifPause = crl::time(200);
 
+// Don't put new readers on a thread that misses frame deadlines that much.
+constexpr auto kLateThreshold = crl::time(8);
+
+[[nodiscard]] int ClipThreadsCount() {
+	static const auto result = std::clamp(
+		QThread::idealThreadCount(),
+		kClipThreadsCountMin,
+		kClipThreadsCountMax);
+	return result;
+}
+
 QImage PrepareFrame(
 		const FrameRequest &request,
 		const QImage &original,
@@ -127,6 +139,9 @@ public:
 	int loadLevel() const {
 		return _loadLevel;
 	}
+	crl::time lateness() const {
+		return _lateness.loadRelaxed();
+	}
 	void append(Reader *reader, const Core::FileLocation &location, const QByteArray &data);
 	void start(Reader *reader);
 	void update(Reader *reader);
@@ -140,6 +155,7 @@ private:
 	void clear();
 
 	QAtomicInt _loadLevel;
+	QAtomicInteger<crl::time> _lateness = 0;
 	using ReaderPointers = QMap<Reader*, QAtomicInt>;
 	ReaderPointers _readerPointers;
 	mutable QMutex _readerPointersMutex;
@@ -203,17 +219,23 @@ Reader::Reader(const QByteArray &data, Callback &&callback)
 }
 
 void Reader::init(const Core::FileLocation &location, const QByteArray &data) {
-	if (Workers.size() < kClipThreadsCount) {
+	if (Workers.size() < ClipThreadsCount()) {
 		_threadIndex = Workers.size();
 		Workers.push_back(std::make_unique<Worker>());
 	} else {
+		// Prefer the least loaded of the threads keeping up with frame
+		// deadlines, if all of them are late - the least late one.
 		_threadIndex = base::RandomIndex(Workers.size());
 		auto loadLevel = 0x7FFFFFFF;
+		auto lateness = std::numeric_limits<crl::time>::max();
 		for (int i = 0, l = int(Workers.size()); i < l; ++i) {
-			const auto level = Workers[i]->manager.loadLevel();
-			if (level < loadLevel) {
+			const auto &manager = Workers[i]->manager;
+			const auto late = std::max(manager.lateness(), kLateThreshold);
+			const auto level = manager.loadLevel();
+			if (late < lateness || (late == lateness && level < loadLevel)) {
 				_threadIndex = i;
 				loadLevel = level;
+				lateness = late;
 			}
 		}
 	}
@@ -894,25 +916,12 @@ void Manager::process() {
 		checkAllReaders = (_readers.size() > _readerPointers.size());
 	}
 
+	// Process due readers earliest deadline first.
+	auto due = std::vector<std::pair<crl::time, ReaderPrivate*>>();
 	for (auto i = _readers.begin(), e = _readers.end(); i != e;) {
 		ReaderPrivate *reader = i.key();
 		if (i.value() <= ms) {
-			ResultHandleState state = handleResult(reader, reader->process(ms), ms);
-			if (state == ResultHandleRemove) {
-				i = _readers.erase(i);
-				continue;
-			} else if (state == ResultHandleStop) {
-				_processingInThread = nullptr;
-				return;
-			}
-			ms = crl::now();
-			if (reader->_videoPausedAtMs) {
-				i.value() = ms + 86400 * 1000ULL;
-			} else if (reader->_nextFrameWhen && reader->_started) {
-				i.value() = reader->_nextFrameWhen;
-			} else {
-				i.value() = (ms + 86400 * 1000ULL);
-			}
+			due.emplace_back(i.value(), reader);
 		} else if (checkAllReaders) {
 			QMutexLocker lock(&_readerPointersMutex);
 			auto it = constUnsafeFindReaderPointer(reader);
@@ -923,10 +932,42 @@ void Manager::process() {
 				continue;
 			}
 		}
-		if (!reader->_autoPausedGif && i.value() < minms) {
+		++i;
+	}
+	ranges::sort(due);
+
+	auto lateness = crl::time(0);
+	for (const auto &[when, reader] : due) {
+		if (when > 0) {
+			accumulate_max(lateness, ms - when);
+		}
+		ResultHandleState state = handleResult(reader, reader->process(ms), ms);
+		if (state == ResultHandleRemove) {
+			_readers.remove(reader);
+			continue;
+		} else if (state == ResultHandleStop) {
+			_processingInThread = nullptr;
+			return;
+		}
+		ms = crl::now();
+		auto &next = _readers[reader];
+		if (reader->_videoPausedAtMs) {
+			next = ms + 86400 * 1000ULL;
+		} else if (reader->_nextFrameWhen && reader->_started) {
+			next = reader->_nextFrameWhen;
+		} else {
+			next = (ms + 86400 * 1000ULL);
+		}
+	}
+	if (!due.empty()) {
+		const auto was = _lateness.loadRelaxed();
+		_lateness.storeRelaxed((was * 3 + lateness) / 4);
+	}
+
+	for (auto i = _readers.cbegin(), e = _readers.cend(); i != e; ++i) {
+		if (!i.key()->_autoPausedGif && i.value() < minms) {
 			minms = i.value();
 		}
-		++i;
 	}
 
 	ms = crl::now();
@@ -21,6 +21,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_changes.h"
 #include "data/data_document.h"
 #include "data/data_file_origin.h"
+#include "data/data_media_preload.h"
 #include "data/data_peer.h"
 #include "data/data_session.h"
 #include "data/data_stories.h"
@@ -68,7 +69,6 @@ constexpr auto kSiblingUserpicSize = 0.3;
 constexpr auto kInnerHeightMultiplier = 1.6;
 constexpr auto kPreloadPeersCount = 3;
 constexpr auto kPreloadStoriesCount = 5;
-constexpr auto kPreloadNextMediaCount = 3;
 constexpr auto kPreloadPreviousMediaCount = 1;
 constexpr auto kMarkAsReadAfterSeconds = 0.2;
 constexpr auto kMarkAsReadAfterProgress = 0.;
@@ -349,6 +349,9 @@ Controller::Controller(not_null<Delegate*> delegate)
 }
 
 Controller::~Controller() {
+	if (_session) {
+		_session->data().preloadScheduler().resetPace();
+	}
 	_captionFullView = nullptr;
 	_repostView = nullptr;
 	changeShown(nullptr);
@@ -814,11 +817,23 @@ void Controller::rebuildFromContext(
 void Controller::preloadNext() {
 	Expects(shown());
 
-	auto ids = std::vector<FullStoryId>();
-	ids.reserve(kPreloadPreviousMediaCount + kPreloadNextMediaCount);
 	const auto peer = shownPeer();
+	auto &scheduler = peer->owner().preloadScheduler();
+	const auto shownStoryId = FullStoryId{
+		.peer = peer->id,
+		.story = shownId(_index),
+	};
+	if (_preloadShown != shownStoryId) {
+		// Context rebuilds of the same story don't count for the pace.
+		_preloadShown = shownStoryId;
+		scheduler.mediaShown();
+	}
+	const auto next = scheduler.aheadCount();
+
+	auto ids = std::vector<FullStoryId>();
+	ids.reserve(kPreloadPreviousMediaCount + next);
 	const auto count = shownCount();
-	const auto till = std::min(_index + kPreloadNextMediaCount, count);
+	const auto till = std::min(_index + next, count);
 	for (auto i = _index + 1; i != till; ++i) {
 		ids.push_back({ .peer = peer->id, .story = shownId(i) });
 	}
@@ -290,6 +290,7 @@ private:
 	bool _paused = false;
 
 	FullStoryId _shown;
+	FullStoryId _preloadShown;
 	TextWithEntities _captionText;
 	Data::StoriesContext _context;
 	std::optional<Data::StoriesSource> _source;
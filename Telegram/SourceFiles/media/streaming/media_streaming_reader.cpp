@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_common.h"
 #include "media/streaming/media_streaming_loader.h"
 #include "storage/cache/storage_cache_database.h"
+#include "base/options.h"
 
 namespace Media {
 namespace Streaming {
@@ -23,12 +24,27 @@ constexpr auto kMaxOnlyInHeader = 80 * kPartSize;
 constexpr auto kPartsOutsideFirstSliceGood = 8;
 constexpr auto kSlicesInMemory = 2;
 
+// Slices of all readers together try to fit this, least recent go first.
+constexpr auto kSlicesMemoryLimitDefault = int64(48 * 1024 * 1024);
+constexpr auto kSlicesMemoryLimitLow = int64(16 * 1024 * 1024);
+
+// Readers report their slices memory when it changes by at least that.
+constexpr auto kSlicesMemoryReportStep = int64(8 * kPartSize);
+
 // 1 MB of parts are requested from cloud ahead of reading demand.
 constexpr auto kPreloadPartsAhead = 8;
 constexpr auto kDownloaderRequestsLimit = 4;
 
 using PartsMap = base::flat_map<uint32, QByteArray>;
 
+base::options::toggle LowMemoryStreaming({
+	.id = kOptionLowMemoryStreaming,
+	.name = "Keep less of streamed media in memory",
+	.description = "Lower the memory shared by all playing videos "
+		"and voice messages from 48 MB to 16 MB.",
+	.restartRequired = true,
+});
+
 struct ParsedCacheEntry {
 	PartsMap parts;
 	std::optional<PartsMap> included;
@@ -194,8 +210,139 @@ void CopyLoaded(
 	}
 }
 
+// Slices are owned by readers working on different threads, so the
+// budget can't unload them itself. Instead it tells each reader how
+// many bytes it may keep and asks the readers that are over their share
+// to unload the rest on their own thread. Least recently used readers
+// get the least of it. Each reader always keeps the slice it reads from,
+// so with many readers the total may exceed the limit.
+class SlicesBudget final {
+public:
+	// The callback receives the allowed bytes and whether to unload now.
+	using Apply = Fn<void(int64 allowed, bool unload)>;
+
+	void add(not_null<const void*> owner, Apply apply);
+	void remove(not_null<const void*> owner);
+
+	// Touched means the owner is the most recently used one now.
+	void update(not_null<const void*> owner, int64 bytes, bool touched);
+
+	void hit();
+	void miss();
+	[[nodiscard]] SlicesCacheStats stats() const;
+
+private:
+	struct Entry {
+		const void *owner = nullptr;
+		Apply apply;
+		int64 bytes = 0;
+		uint64 touched = 0;
+		bool unloadRequested = false;
+	};
+
+	void balance(const void *current = nullptr);
+
+	mutable QMutex _mutex;
+	std::vector<Entry> _entries;
+	uint64 _touchCounter = 0;
+	const int64 _limit = LowMemoryStreaming.value()
+		? kSlicesMemoryLimitLow
+		: kSlicesMemoryLimitDefault;
+	std::atomic<int64> _hits = 0;
+	std::atomic<int64> _misses = 0;
+
+};
+
+void SlicesBudget::add(not_null<const void*> owner, Apply apply) {
+	QMutexLocker lock(&_mutex);
+
+	Expects(!ranges::contains(_entries, owner.get(), &Entry::owner));
+
+	_entries.push_back({
+		.owner = owner.get(),
+		.apply = std::move(apply),
+		.touched = ++_touchCounter,
+	});
+	balance(owner);
+}
+
+void SlicesBudget::remove(not_null<const void*> owner) {
+	QMutexLocker lock(&_mutex);
+
+	const auto i = ranges::find(_entries, owner.get(), &Entry::owner);
+	if (i != end(_entries)) {
+		_entries.erase(i);
+		balance();
+	}
+}
+
+void SlicesBudget::update(
+		not_null<const void*> owner,
+		int64 bytes,
+		bool touched) {
+	QMutexLocker lock(&_mutex);
+
+	const auto i = ranges::find(_entries, owner.get(), &Entry::owner);
+	Assert(i != end(_entries));
+
+	i->bytes = bytes;
+	i->unloadRequested = false;
+	if (touched) {
+		i->touched = ++_touchCounter;
+	}
+	balance(owner);
+}
+
+void SlicesBudget::balance(const void *current) {
+	ranges::sort(_entries, ranges::greater(), &Entry::touched);
+
+	auto left = _limit;
+	for (auto &entry : _entries) {
+		const auto allowed = std::max(left, int64(0));
+		left -= std::min(entry.bytes, allowed);
+
+		const auto unload = (entry.bytes > allowed)
+			&& (entry.owner != current)
+			&& !entry.unloadRequested;
+		if (unload) {
+			entry.unloadRequested = true;
+		}
+		entry.apply(allowed, unload);
+	}
+}
+
+void SlicesBudget::hit() {
+	++_hits;
+}
+
+void SlicesBudget::miss() {
+	++_misses;
+}
+
+SlicesCacheStats SlicesBudget::stats() const {
+	QMutexLocker lock(&_mutex);
+
+	auto bytes = int64(0);
+	for (const auto &entry : _entries) {
+		bytes += entry.bytes;
+	}
+	return {
+		.hits = _hits.load(),
+		.misses = _misses.load(),
+		.bytes = bytes,
+		.limit = _limit,
+	};
+}
+
+[[nodiscard]] SlicesBudget &Budget() {
+	static auto result = SlicesBudget();
+	return result;
+}
+
 } // namespace
 
+const char kOptionLowMemoryStreaming[] = "low-memory-streaming";
+
 template <int Size>
 bool Reader::StackIntVector<Size>::add(uint32 value) {
 	using namespace rpl::mappers;
@@ -641,7 +788,9 @@ auto Reader::Slices::fill(uint32 offset, bytes::span buffer) -> FillResult {
 		}
 		result.toCache = serializeAndUnloadUnused();
 		result.state = FillState::Success;
+		Budget().hit();
 	} else {
+		Budget().miss();
 		handleReadFromCache(fromSlice);
 		if (fromSlice + 1 < tillSlice) {
 			handleReadFromCache(fromSlice + 1);
@@ -669,6 +818,9 @@ auto Reader::Slices::fillFromHeader(uint32 offset, bytes::span buffer)
 			from,
 			till);
 		result.state = FillState::Success;
+		Budget().hit();
+	} else {
+		Budget().miss();
 	}
 	return result;
 }
@@ -708,12 +860,33 @@ void Reader::Slices::markSliceUsed(int sliceIndex) {
 	const auto end = _usedSlices.end();
 	if (i == end) {
 		_usedSlices.push_back(sliceIndex);
+		_usedSlicesChanged = true;
 	} else {
 		const auto next = i + 1;
 		if (next != end) {
 			std::rotate(i, next, end);
+			_usedSlicesChanged = true;
+		}
+	}
+}
+
+int64 Reader::Slices::usedBytes() const {
+	auto result = int64(0);
+	for (const auto index : _usedSlices) {
+		for (const auto &[offset, part] : _data[index].parts) {
+			result += part.size();
 		}
 	}
+	return result;
+}
+
+void Reader::Slices::reportUsedBytes(int64 bytes, bool touched) {
+	_reportedBytes = bytes;
+	Budget().update(this, bytes, touched);
+}
+
+void Reader::Slices::setAllowedBytes(int64 allowed) {
+	_allowedBytes.store(allowed, std::memory_order_relaxed);
 }
 
 int Reader::Slices::maxSliceSize(int sliceNumber) const {
@@ -721,12 +894,44 @@ int Reader::Slices::maxSliceSize(int sliceNumber) const {
 }
 
 Reader::SerializedSlice Reader::Slices::serializeAndUnloadUnused() {
-	using Flag = Slice::Flag;
-
-	if (_headerMode == HeaderMode::Unknown
-		|| _usedSlices.size() <= kSlicesInMemory) {
+	const auto bytes = usedBytes();
+	if (base::take(_usedSlicesChanged)
+		|| std::abs(bytes - _reportedBytes) >= kSlicesMemoryReportStep) {
+		reportUsedBytes(bytes, true);
+	}
+	if (!overBudget(bytes)) {
 		return {};
 	}
+	auto result = serializeAndUnloadFirstUsed();
+	reportUsedBytes(usedBytes(), false);
+	return result;
+}
+
+bool Reader::Slices::overBudget(int64 bytes) const {
+	// Each reader keeps at least the slice it reads from.
+	return (_headerMode != HeaderMode::Unknown)
+		&& (_usedSlices.size() > 1)
+		&& (_usedSlices.size() > kSlicesInMemory
+			|| bytes > _allowedBytes.load(std::memory_order_relaxed));
+}
+
+bool Reader::Slices::overBudget() const {
+	return overBudget(usedBytes());
+}
+
+Reader::SerializedSlice Reader::Slices::unloadOverBudget() {
+	Expects(overBudget());
+
+	auto result = serializeAndUnloadFirstUsed();
+	reportUsedBytes(usedBytes(), false);
+	return result;
+}
+
+Reader::SerializedSlice Reader::Slices::serializeAndUnloadFirstUsed() {
+	using Flag = Slice::Flag;
+
+	Expects(!_usedSlices.empty());
+
 	const auto purgeSlice = _usedSlices.front();
 	_usedSlices.pop_front();
 	if (!(_data[purgeSlice].flags & Flag::LoadedFromCache)) {
@@ -873,10 +1078,26 @@ Reader::Reader(
 	if (_cacheHelper) {
 		readFromCache(0);
 	}
+
+	// Called from other readers threads, the slices are unloaded here
+	// the next time the streaming thread wakes up.
+	Budget().add(&_slices, [=](int64 allowed, bool unload) {
+		_slices.setAllowedBytes(allowed);
+		if (!unload) {
+			return;
+		}
+		_unloadRequested.store(true, std::memory_order_release);
+		wakeFromSleep();
+		if (const auto waiting = _waiting.load(std::memory_order_acquire)) {
+			_waiting.store(nullptr, std::memory_order_release);
+			waiting->release();
+		}
+	});
 }
 
 void Reader::startSleep(not_null<crl::semaphore*> wake) {
 	_sleeping.store(wake, std::memory_order_release);
+	unloadOverBudget();
 	processDownloaderRequests();
 }
 
@@ -1257,6 +1478,7 @@ Reader::FillState Reader::fill(
 		return FillState::Failed;
 	};
 
+	unloadOverBudget();
 	checkForSomethingMoreReceived();
 	if (_streamingError) {
 		return FillState::Failed;
@@ -1287,15 +1509,7 @@ Reader::FillState Reader::fillFromSlices(uint32 offset, bytes::span buffer) {
 		readFromCache(sliceNumber);
 	}
 
-	if (_cacheHelper && result.toCache.number >= 0) {
-		// If we put to cache the header (number == 0) that means we're in
-		// HeaderMode::Good and really are putting the first slice to cache.
-		Assert(result.toCache.number > 0 || _slices.isGoodHeader());
-
-		const auto index = std::max(result.toCache.number, 1) - 1;
-		cancelLoadInRange(index * kInSlice, (index + 1) * kInSlice);
-		putToCache(std::move(result.toCache));
-	}
+	putUnloadedToCache(std::move(result.toCache));
 	auto checkPriority = true;
 	for (const auto offset : result.offsetsFromLoader.values()) {
 		if (checkPriority) {
@@ -1406,8 +1620,42 @@ void Reader::finalizeCache() {
 	_cache->sync();
 }
 
+void Reader::putUnloadedToCache(SerializedSlice &&data) {
+	if (_cacheHelper && data.number >= 0) {
+		// If we put to cache the header (number == 0) that means we're in
+		// HeaderMode::Good and really are putting the first slice to cache.
+		Assert(data.number > 0 || _slices.isGoodHeader());
+
+		const auto index = std::max(data.number, 1) - 1;
+		cancelLoadInRange(index * kInSlice, (index + 1) * kInSlice);
+		putToCache(std::move(data));
+	}
+}
+
+void Reader::unloadOverBudget() {
+	if (!_unloadRequested.exchange(false, std::memory_order_acq_rel)) {
+		return;
+	}
+	while (_slices.overBudget()) {
+		putUnloadedToCache(_slices.unloadOverBudget());
+	}
+}
+
 Reader::~Reader() {
+	Budget().remove(&_slices);
 	finalizeCache();
+
+	const auto stats = SlicesCacheStatistics();
+	DEBUG_LOG(("Streaming Info: Slices cache %1 hits, %2 misses, "
+		"%3 / %4 bytes."
+		).arg(stats.hits
+		).arg(stats.misses
+		).arg(stats.bytes
+		).arg(stats.limit));
+}
+
+SlicesCacheStats SlicesCacheStatistics() {
+	return Budget().stats();
 }
 
 QByteArray SerializeComplexPartsMap(
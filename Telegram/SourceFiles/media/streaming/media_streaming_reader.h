@@ -167,6 +167,9 @@ private:
 
 		[[nodiscard]] FillResult fill(uint32 offset, bytes::span buffer);
 		[[nodiscard]] SerializedSlice unloadToCache();
+		[[nodiscard]] bool overBudget() const;
+		[[nodiscard]] SerializedSlice unloadOverBudget();
+		void setAllowedBytes(int64 allowed);
 
 		[[nodiscard]] QByteArray partForDownloader(uint32 offset) const;
 		[[nodiscard]] bool readCacheForDownloaderRequired(uint32 offset);
@@ -185,10 +188,14 @@ private:
 		[[nodiscard]] SerializedSlice serializeAndUnloadSlice(
 			int sliceNumber);
 		[[nodiscard]] SerializedSlice serializeAndUnloadUnused();
+		[[nodiscard]] SerializedSlice serializeAndUnloadFirstUsed();
 		[[nodiscard]] QByteArray serializeComplexSlice(
 			const Slice &slice) const;
 		[[nodiscard]] QByteArray serializeAndUnloadFirstSliceNoHeader();
 		void markSliceUsed(int sliceIndex);
+		[[nodiscard]] int64 usedBytes() const;
+		[[nodiscard]] bool overBudget(int64 bytes) const;
+		void reportUsedBytes(int64 bytes, bool touched);
 		[[nodiscard]] bool computeIsGoodHeader() const;
 		[[nodiscard]] FillResult fillFromHeader(
 			uint32 offset,
@@ -200,8 +207,12 @@ private:
 		std::vector<Slice> _data;
 		Slice _header;
 		std::deque<int> _usedSlices;
+		std::atomic<int64> _allowedBytes
+			= std::numeric_limits<int64>::max();
+		int64 _reportedBytes = 0;
 		uint32 _size = 0;
 		HeaderMode _headerMode = HeaderMode::Unknown;
+		bool _usedSlicesChanged = false;
 		bool _fullInCache = false;
 
 	};
@@ -212,6 +223,8 @@ private:
 	[[nodiscard]] bool readFromCacheForDownloader(int sliceNumber);
 	bool processCacheResults();
 	void putToCache(SerializedSlice &&data);
+	void putUnloadedToCache(SerializedSlice &&data);
+	void unloadOverBudget();
 
 	void cancelLoadInRange(uint32 from, uint32 till);
 	void loadAtOffset(uint32 offset);
@@ -249,6 +262,7 @@ private:
 	std::atomic<crl::semaphore*> _waiting = nullptr;
 	std::atomic<crl::semaphore*> _sleeping = nullptr;
 	std::atomic<bool> _stopStreamingAsync = false;
+	std::atomic<bool> _unloadRequested = false;
 	PriorityQueue _loadingOffsets;
 
 	Slices _slices;
@@ -282,5 +296,16 @@ private:
 [[nodiscard]] QByteArray SerializeComplexPartsMap(
 	const base::flat_map<uint32, QByteArray> &parts);
 
+// Slices of all readers in the process share one memory limit.
+struct SlicesCacheStats {
+	int64 hits = 0;
+	int64 misses = 0;
+	int64 bytes = 0;
+	int64 limit = 0;
+};
+[[nodiscard]] SlicesCacheStats SlicesCacheStatistics();
+
+extern const char kOptionLowMemoryStreaming[];
+
 } // namespace Streaming
 } // namespace Media
@@ -26,19 +26,34 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/call_delayed.h"
 #include "base/timer.h"
 #include "base/network_reachability.h"
+#include "base/options.h"
 
 namespace MTP {
 namespace {
 
 constexpr auto kConfigBecomesOldIn = 2 * 60 * crl::time(1000);
 constexpr auto kConfigBecomesOldForBlockedIn = 8 * crl::time(1000);
+constexpr auto kWarmMediaSessionsCount = 1;
+constexpr auto kWarmMediaDcsLimit = 2;
+constexpr auto kWarmMediaSessionsPingTimeout = 30 * crl::time(1000);
+constexpr auto kWarmMediaSessionsIdleTimeout = 10 * 60 * crl::time(1000);
 
 using namespace details;
 
 std::atomic<int> GlobalAtomicRequestId = 0;
 
+base::options::toggle WarmMediaSessions({
+	.id = kOptionWarmMediaSessions,
+	.name = "Keep media connections warm",
+	.description = "Keep a download connection to the two most recently "
+		"used media servers for 10 minutes after the last use.",
+	.restartRequired = true,
+});
+
 } // namespace
 
+const char kOptionWarmMediaSessions[] = "warm-media-sessions";
+
 namespace details {
 
 int GetNextRequestId() {
@@ -113,6 +128,8 @@ public:
 	void reInitConnection(DcId dcId);
 	void logout(Fn<void()> done);
 
+	void warmMediaSessions(DcId dcId);
+
 	not_null<Dcenter*> getDcById(ShiftedDcId shiftedDcId);
 	Dcenter *findDc(ShiftedDcId shiftedDcId);
 	not_null<Dcenter*> addDc(
@@ -206,6 +223,10 @@ private:
 	void logoutGuestDcs();
 	bool logoutGuestDone(mtpRequestId requestId);
 
+	[[nodiscard]] bool isWarmMediaSession(ShiftedDcId shiftedDcId) const;
+	void coolMediaSessions(DcId dcId);
+	void pingWarmMediaSessions();
+
 	void requestConfigIfExpired();
 	void configLoadDone(const MTPConfig &result);
 	bool configLoadFail(const Error &error);
@@ -289,6 +310,13 @@ private:
 
 	base::Timer _checkDelayedTimer;
 
+	// Media sessions for these dcs are kept connected between tasks.
+	base::flat_map<DcId, crl::time> _warmMediaDcs; // dcId -> last use.
+	const int _warmMediaSessionsCount = WarmMediaSessions.value()
+		? kWarmMediaSessionsCount
+		: 0;
+	base::Timer _warmMediaSessionsTimer;
+
 	Core::SettingsProxy &_proxySettings;
 
 	rpl::lifetime _lifetime;
@@ -380,6 +408,9 @@ void Instance::Private::start() {
 	}
 
 	_checkDelayedTimer.setCallback([this] { checkDelayedRequests(); });
+	_warmMediaSessionsTimer.setCallback([this] {
+		pingWarmMediaSessions();
+	});
 
 	Assert(!hasMainDcId() == isKeysDestroyer());
 	requestConfig();
@@ -696,13 +727,102 @@ void Instance::Private::killSession(ShiftedDcId shiftedDcId) {
 }
 
 void Instance::Private::stopSession(ShiftedDcId shiftedDcId) {
-	if (const auto session = findSession(shiftedDcId)) {
+	if (isWarmMediaSession(shiftedDcId)) {
+		return;
+	} else if (const auto session = findSession(shiftedDcId)) {
 		if (session != _mainSession) { // don't stop main session
 			session->stop();
 		}
 	}
 }
 
+void Instance::Private::warmMediaSessions(DcId dcId) {
+	if (!_warmMediaSessionsCount || isKeysDestroyer() || !hasMainDcId()) {
+		return;
+	}
+	_warmMediaDcs[dcId] = crl::now();
+	if (_warmMediaDcs.size() > kWarmMediaDcsLimit) {
+		const auto oldest = ranges::min_element(
+			_warmMediaDcs,
+			ranges::less(),
+			[&](const auto &pair) {
+				return (pair.first == dcId)
+					? std::numeric_limits<crl::time>::max()
+					: pair.second;
+			});
+		coolMediaSessions(oldest->first);
+	}
+	const auto main = (dcId == mainDcId());
+	for (auto i = 0; i != _warmMediaSessionsCount; ++i) {
+		const auto download = details::downloadDcId(dcId, i);
+		if (!findSession(download)) {
+			startSession(download)->ping();
+		}
+		const auto upload = details::uploadDcId(dcId, i);
+		if (main && !findSession(upload)) {
+			startSession(upload)->ping();
+		}
+	}
+	if (!_warmMediaSessionsTimer.isActive()) {
+		_warmMediaSessionsTimer.callEach(kWarmMediaSessionsPingTimeout);
+	}
+}
+
+bool Instance::Private::isWarmMediaSession(ShiftedDcId shiftedDcId) const {
+	const auto dcId = BareDcId(shiftedDcId);
+	const auto shift = GetDcIdShift(shiftedDcId);
+	if (isDownloadDcId(shiftedDcId)) {
+		return _warmMediaDcs.contains(dcId)
+			&& (shift - kBaseDownloadDcShift < _warmMediaSessionsCount);
+	} else if (isUploadDcId(shiftedDcId)) {
+		const auto main = !dcId
+			|| (hasMainDcId() && dcId == mainDcId());
+		return main
+			&& _warmMediaDcs.contains(mainDcId())
+			&& (shift - kBaseUploadDcShift < _warmMediaSessionsCount);
+	}
+	return false;
+}
+
+void Instance::Private::coolMediaSessions(DcId dcId) {
+	auto warm = std::vector<ShiftedDcId>();
+	for (const auto &[shiftedDcId, session] : _sessions) {
+		if (isWarmMediaSession(shiftedDcId)) {
+			warm.push_back(shiftedDcId);
+		}
+	}
+	_warmMediaDcs.remove(dcId);
+
+	// Their idle stopSession() calls were ignored, stop them now.
+	for (const auto shiftedDcId : warm) {
+		if (!isWarmMediaSession(shiftedDcId)) {
+			stopSession(shiftedDcId);
+		}
+	}
+}
+
+void Instance::Private::pingWarmMediaSessions() {
+	const auto now = crl::now();
+	auto idle = std::vector<DcId>();
+	for (const auto &[dcId, used] : _warmMediaDcs) {
+		if (now - used >= kWarmMediaSessionsIdleTimeout) {
+			idle.push_back(dcId);
+		}
+	}
+	for (const auto dcId : idle) {
+		coolMediaSessions(dcId);
+	}
+	if (_warmMediaDcs.empty()) {
+		_warmMediaSessionsTimer.cancel();
+		return;
+	}
+	for (const auto &[shiftedDcId, session] : _sessions) {
+		if (isWarmMediaSession(shiftedDcId)) {
+			session->ping();
+		}
+	}
+}
+
 void Instance::Private::reInitConnection(DcId dcId) {
 	for (const auto &[shiftedDcId, session] : _sessions) {
 		if (BareDcId(shiftedDcId) == dcId) {
@@ -1964,6 +2084,10 @@ void Instance::stopSession(ShiftedDcId shiftedDcId) {
 	_private->stopSession(shiftedDcId);
 }
 
+void Instance::warmMediaSessions(DcId dcId) {
+	_private->warmMediaSessions(dcId);
+}
+
 void Instance::reInitConnection(DcId dcId) {
 	_private->reInitConnection(dcId);
 }
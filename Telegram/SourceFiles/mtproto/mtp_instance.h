@@ -101,6 +101,12 @@ public:
 	void killSession(ShiftedDcId shiftedDcId);
 	void stopSession(ShiftedDcId shiftedDcId);
 	void reInitConnection(DcId dcId);
+
+	// With the "warm-media-sessions" option it keeps the first download
+	// session of the two most recently used dcs (and the upload session
+	// of the main dc) connected until ten minutes of idle, so that media
+	// after a short pause does not wait for a connection and key binding.
+	void warmMediaSessions(DcId dcId);
 	void logout(Fn<void()> done);
 
 	void setUpdatesHandler(Fn<void(const Response&)> handler);
@@ -243,4 +249,6 @@ private:
 
 };
 
+extern const char kOptionWarmMediaSessions[];
+
 } // namespace MTP
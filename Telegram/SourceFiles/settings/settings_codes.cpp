@@ -27,6 +27,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "window/themes/window_theme_editor.h"
 #include "window/window_session_controller.h"
 #include "media/audio/media_audio_track.h"
+#include "media/streaming/media_streaming_reader.h"
 #include "settings/settings_folders.h"
 #include "api/api_updates.h"
 #include "base/qt/qt_common_adapters.h"
@@ -243,6 +244,32 @@ auto GenerateCodes() {
 			});
 		});
 	});
+	codes.emplace(u"memoryreport"_q, [](SessionController *window) {
+		if (!window) {
+			return;
+		}
+		constexpr auto kMaxPeers = 20;
+		const auto report = window->session().data().messagesMemoryReport();
+		const auto kb = [](int64 bytes) { return (bytes + 1023) / 1024; };
+		LOG(("Memory Report: %1 messages, %2 KB."
+			).arg(report.front().count
+			).arg(kb(report.front().bytes)));
+		const auto count = std::min(int(report.size()), kMaxPeers + 1);
+		for (auto i = 1; i != count; ++i) {
+			LOG(("Memory Report: peer %1, %2 messages, %3 KB."
+				).arg(report[i].peer.value
+				).arg(report[i].count
+				).arg(kb(report[i].bytes)));
+		}
+		const auto slices = Media::Streaming::SlicesCacheStatistics();
+		LOG(("Memory Report: streaming slices %1 / %2 KB, "
+			"%3 cache hits, %4 misses."
+			).arg(kb(slices.bytes)
+			).arg(kb(slices.limit)
+			).arg(slices.hits
+			).arg(slices.misses));
+		Ui::Toast::Show("Memory report was written to log.txt.");
+	});
 	codes.emplace(u"testchatcolors"_q, [](SessionController *window) {
 		const auto now = !Data::CloudThemes::TestingColors();
 		Data::CloudThemes::SetTestingColors(now);
@@ -24,6 +24,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lang/lang_keys.h"
 #include "mainwindow.h"
 #include "media/player/media_player_instance.h"
+#include "media/streaming/media_streaming_reader.h"
+#include "mtproto/mtp_instance.h"
 #include "mtproto/session_private.h"
 #include "webview/webview_embed.h"
 #include "window/main_window.h"
@@ -33,6 +35,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "window/notifications_manager.h"
 #include "storage/localimageloader.h"
 #include "data/data_document_resolver.h"
+#include "data/data_histories.h"
 #include "styles/style_settings.h"
 #include "styles/style_layers.h"
 
@@ -148,6 +151,7 @@ void SetupExperimental(
 	addToggle(Info::Profile::kOptionShowPeerIdBelowAbout);
 	addToggle(Ui::kOptionUseSmallMsgBubbleRadius);
 	addToggle(Media::Player::kOptionDisableAutoplayNext);
+	addToggle(Media::Streaming::kOptionLowMemoryStreaming);
 	addToggle(kOptionSendLargePhotos);
 	addToggle(Webview::kOptionWebviewDebugEnabled);
 	addToggle(Webview::kOptionWebviewLegacyEdge);
@@ -156,8 +160,10 @@ void SetupExperimental(
 	addToggle(Core::kOptionFreeType);
 	addToggle(Core::kOptionSkipUrlSchemeRegister);
 	addToggle(Data::kOptionExternalVideoPlayer);
+	addToggle(Data::kOptionUnloadHiddenChatsSooner);
 	addToggle(Window::kOptionNewWindowsSizeAsFirst);
 	addToggle(MTP::details::kOptionPreferIPv6);
+	addToggle(MTP::kOptionWarmMediaSessions);
 	addToggle(Window::kOptionDisableTouchbar);
 }
 
@@ -10,142 +10,83 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Statistic {
 namespace {
 
-constexpr auto kMinArraySize = size_t(30);
+[[nodiscard]] int FloorLog2(int value) {
+	auto result = 0;
+	while (value >>= 1) {
+		++result;
+	}
+	return result;
+}
 
 } // namespace
 
 SegmentTree::SegmentTree(std::vector<ChartValue> array)
 : _array(std::move(array)) {
-	if (_array.size() < kMinArraySize) {
-		return;
-	}
-
-	// The max size of this array is about 2 * 2 ^ log2(n) + 1.
-	const auto size = 2 * std::pow(
-		2.,
-		std::floor((std::log(_array.size()) / std::log(2.)) + 1));
-	_heap.resize(int(size));
-	build(1, 0, _array.size());
+	build(_maxLevels, std::greater<>());
+	build(_minLevels, std::less<>());
 }
 
-void SegmentTree::build(ChartValue v, int from, int size) {
-	_heap[v].from = from;
-	_heap[v].to = (from + size - 1);
-
-	if (size == 1) {
-		_heap[v].sum = _array[from];
-		_heap[v].max = _array[from];
-		_heap[v].min = _array[from];
-	} else {
-		// Build children.
-		build(2 * v, from, size / 2);
-		build(2 * v + 1, from + size / 2, size - size / 2);
-
-		_heap[v].sum = _heap[2 * v].sum + _heap[2 * v + 1].sum;
-		// max = max of the children.
-		_heap[v].max = std::max(_heap[2 * v].max, _heap[2 * v + 1].max);
-		_heap[v].min = std::min(_heap[2 * v].min, _heap[2 * v + 1].min);
-	}
-}
-
-ChartValue SegmentTree::rMaxQ(int from, int to) {
-	if (_array.size() < kMinArraySize) {
-		auto max = ChartValue(0);
-		from = std::max(from, 0);
-		to = std::min(to, int(_array.size() - 1));
-		for (auto i = from; i <= to; i++) {
-			max = std::max(max, _array[i]);
-		}
-		return max;
-	}
-	return rMaxQ(1, from, to);
-}
-
-ChartValue SegmentTree::rMaxQ(ChartValue v, int from, int to) {
-	const auto &n = _heap[v];
-	// If you did a range update that contained this node,
-	// you can infer the Min value without going down the tree.
-	if (n.pendingVal && contains(n.from, n.to, from, to)) {
-		return n.pendingVal.value;
-	}
-
-	if (contains(from, to, n.from, n.to)) {
-		return _heap[v].max;
+template <typename Better>
+void SegmentTree::build(
+		std::vector<std::vector<int>> &levels,
+		Better better) {
+	const auto size = int(_array.size());
+	if (!size) {
+		return;
 	}
-
-	if (intersects(from, to, n.from, n.to)) {
-		propagate(v);
-		const auto leftMin = rMaxQ(2 * v, from, to);
-		const auto rightMin = rMaxQ(2 * v + 1, from, to);
-
-		return std::max(leftMin, rightMin);
+	levels.resize(FloorLog2(size) + 1);
+	levels[0].resize(size);
+	for (auto i = 0; i != size; ++i) {
+		levels[0][i] = i;
 	}
-
-	return 0;
-}
-
-ChartValue SegmentTree::rMinQ(int from, int to) {
-	if (_array.size() < kMinArraySize) {
-		auto min = std::numeric_limits<ChartValue>::max();
-		from = std::max(from, 0);
-		to = std::min(to, int(_array.size() - 1));
-		for (auto i = from; i <= to; i++) {
-			min = std::min(min, _array[i]);
+	for (auto k = 1; k != int(levels.size()); ++k) {
+		const auto &previous = levels[k - 1];
+		const auto half = (1 << (k - 1));
+		auto &level = levels[k];
+		level.resize(size - (1 << k) + 1);
+		for (auto i = 0; i != int(level.size()); ++i) {
+			const auto a = previous[i];
+			const auto b = previous[i + half];
+			level[i] = better(_array[b], _array[a]) ? b : a;
 		}
-		return min;
 	}
-	return rMinQ(1, from, to);
 }
 
-ChartValue SegmentTree::rMinQ(ChartValue v, int from, int to) {
-	const auto &n = _heap[v];
-	// If you did a range update that contained this node,
-	// you can infer the Min value without going down the tree.
-	if (n.pendingVal && contains(n.from, n.to, from, to)) {
-		return n.pendingVal.value;
+template <typename Better>
+int SegmentTree::query(
+		const std::vector<std::vector<int>> &levels,
+		int from,
+		int to,
+		Better better) const {
+	from = std::max(from, 0);
+	to = std::min(to, int(_array.size()) - 1);
+	if (from > to) {
+		return -1;
 	}
-
-	if (contains(from, to, n.from, n.to)) {
-		return _heap[v].min;
-	}
-
-	if (intersects(from, to, n.from, n.to)) {
-		propagate(v);
-		const auto leftMin = rMinQ(2 * v, from, to);
-		const auto rightMin = rMinQ(2 * v + 1, from, to);
-
-		return std::min(leftMin, rightMin);
-	}
-
-	return std::numeric_limits<ChartValue>::max();
+	const auto k = FloorLog2(to - from + 1);
+	const auto a = levels[k][from];
+	const auto b = levels[k][to - (1 << k) + 1];
+	return better(_array[b], _array[a]) ? b : a;
 }
 
-void SegmentTree::propagate(ChartValue v) {
-	auto &n = _heap[v];
-
-	if (n.pendingVal) {
-		const auto value = n.pendingVal.value;
-		n.pendingVal = {};
-		change(_heap[2 * v], value);
-		change(_heap[2 * v + 1], value);
-	}
+int SegmentTree::rMaxIndexQ(int from, int to) const {
+	return query(_maxLevels, from, to, std::greater<>());
 }
 
-void SegmentTree::change(SegmentTree::Node &n, ChartValue value) {
-	n.pendingVal = { value, true };
-	n.sum = n.size() * value;
-	n.max = value;
-	n.min = value;
-	_array[n.from] = value;
+int SegmentTree::rMinIndexQ(int from, int to) const {
+	return query(_minLevels, from, to, std::less<>());
 }
 
-bool SegmentTree::contains(int from1, int to1, int from2, int to2) const {
-	return (from2 >= from1) && (to2 <= to1);
+ChartValue SegmentTree::rMaxQ(int from, int to) const {
+	const auto index = rMaxIndexQ(from, to);
+	return (index >= 0) ? _array[index] : 0;
 }
 
-bool SegmentTree::intersects(int from1, int to1, int from2, int to2) const {
-	return ((from1 <= from2) && (to1 >= from2)) // (.[..)..] or (.[...]..)
-		|| ((from1 >= from2) && (from1 <= to2)); // [.(..]..) or [..(..)..
+ChartValue SegmentTree::rMinQ(int from, int to) const {
+	const auto index = rMinIndexQ(from, to);
+	return (index >= 0)
+		? _array[index]
+		: std::numeric_limits<ChartValue>::max();
 }
 
 } // namespace Statistic
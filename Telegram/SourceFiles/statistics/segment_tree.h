@@ -11,6 +11,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Statistic {
 
+// Sparse table of range extremums: O(n log n) to build, O(1) to query.
+// Its levels are also a min / max pyramid used for lines decimation.
 class SegmentTree final {
 public:
 	SegmentTree() = default;
@@ -23,48 +25,29 @@ public:
 		return !empty();
 	}
 
-	[[nodiscard]] ChartValue rMaxQ(int from, int to);
-	[[nodiscard]] ChartValue rMinQ(int from, int to);
+	[[nodiscard]] ChartValue rMaxQ(int from, int to) const;
+	[[nodiscard]] ChartValue rMinQ(int from, int to) const;
 
-private:
-	struct Node final {
-		ChartValue sum = 0;
-		ChartValue max = 0;
-		ChartValue min = 0;
-
-		struct PendingVal {
-			[[nodiscard]] explicit operator bool() const {
-				return available;
-			}
-			ChartValue value = 0;
-			bool available = false;
-		};
-		PendingVal pendingVal;
-
-		int from = 0;
-		int to = 0;
-
-		[[nodiscard]] int size() {
-			return to - from + 1;
-		}
-	};
+	// Index of the extremum in [from, to] or -1 if the range is empty.
+	[[nodiscard]] int rMaxIndexQ(int from, int to) const;
+	[[nodiscard]] int rMinIndexQ(int from, int to) const;
 
-	void build(ChartValue v, int from, int size);
-	void propagate(ChartValue v);
-	void change(Node &n, ChartValue value);
-
-	[[nodiscard]] ChartValue rMaxQ(ChartValue v, int from, int to);
-	[[nodiscard]] ChartValue rMinQ(ChartValue v, int from, int to);
+private:
+	template <typename Better>
+	void build(std::vector<std::vector<int>> &levels, Better better);
 
-	[[nodiscard]] bool contains(int from1, int to1, int from2, int to2) const;
-	[[nodiscard]] bool intersects(
-		int from1,
-		int to1,
-		int from2,
-		int to2) const;
+	template <typename Better>
+	[[nodiscard]] int query(
+		const std::vector<std::vector<int>> &levels,
+		int from,
+		int to,
+		Better better) const;
 
 	std::vector<ChartValue> _array;
-	std::vector<Node> _heap;
+
+	// Level k keeps the extremum index of [i, i + 2^k) for each i.
+	std::vector<std::vector<int>> _maxLevels;
+	std::vector<std::vector<int>> _minLevels;
 
 };
 
@@ -18,6 +18,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Statistic {
 namespace {
 
+constexpr auto kDecimateAfterPointsPerPixel = 2;
+
 void PaintChartLine(
 		QPainter &p,
 		int lineIndex,
@@ -35,10 +37,7 @@ void PaintChartLine(
 
 	const auto ratio = ratios.ratio(line.id);
 
-	for (auto i = localStart; i <= localEnd; i++) {
-		if (line.y[i] < 0) {
-			continue;
-		}
+	const auto append = [&](int i) {
 		const auto xPoint = c.rect.width()
 			* ((c.chartData.xPercentage[i] - c.xPercentageLimits.min)
 				/ (c.xPercentageLimits.max - c.xPercentageLimits.min));
@@ -46,6 +45,48 @@ void PaintChartLine(
 			/ float64(c.heightLimits.max - c.heightLimits.min);
 		const auto yPoint = (1. - yPercentage) * c.rect.height();
 		chartPoints << QPointF(xPoint, yPoint);
+	};
+
+	const auto count = localEnd - localStart + 1;
+	const auto columns = c.rect.width();
+	const auto decimate = (columns > 0)
+		&& (count > columns * kDecimateAfterPointsPerPixel)
+		&& (line.minValue >= 0);
+	if (!decimate) {
+		chartPoints.reserve(count);
+		for (auto i = localStart; i <= localEnd; i++) {
+			if (line.y[i] < 0) {
+				continue;
+			}
+			append(i);
+		}
+	} else {
+		// Keep first, min, max and last points of each pixel column,
+		// that draws the same polyline as with all of the points.
+		chartPoints.reserve(columns * 4);
+		const auto step = count / float64(columns);
+		auto till = localStart;
+		for (auto column = 0; column != columns; ++column) {
+			const auto from = till;
+			till = (column + 1 == columns)
+				? (localEnd + 1)
+				: (localStart + int((column + 1) * step));
+			if (from >= till) {
+				continue;
+			}
+			auto indices = std::array<int, 4>{
+				from,
+				line.segmentTree.rMinIndexQ(from, till - 1),
+				line.segmentTree.rMaxIndexQ(from, till - 1),
+				till - 1,
+			};
+			ranges::sort(indices);
+			for (auto k = 0; k != int(indices.size()); ++k) {
+				if (!k || indices[k] != indices[k - 1]) {
+					append(indices[k]);
+				}
+			}
+		}
 	}
 	p.setPen(QPen(
 		line.color,
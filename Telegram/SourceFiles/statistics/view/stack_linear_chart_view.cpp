@@ -307,7 +307,16 @@ void StackLinearChartView::paintChartOrZoomAnimation(
 		ovalPath = ovalPath.intersected(rectPath);
 	}
 
-	for (auto i = localStart; i <= localEnd; i++) {
+	// Don't stack more than one point per pixel column.
+	const auto step = hasTransitionAnimation
+		? 1.
+		: std::max(
+			std::floor((localEnd - localStart + 1) / c.rect.width()),
+			1.);
+	const auto nextIndex = [&](float64 i) {
+		return (i == localEnd) ? (i + 1) : std::min(i + step, localEnd);
+	};
+	for (auto i = localStart; i <= localEnd; i = nextIndex(i)) {
 		auto stackOffset = 0.;
 		auto sum = 0.;
 		auto lastEnabled = int(0);
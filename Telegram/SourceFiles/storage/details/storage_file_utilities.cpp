@@ -25,11 +25,21 @@ constexpr auto TdfMagicLen = int(sizeof(TdfMagic));
 
 constexpr auto kStrongIterationsCount = 100'000;
 
+// Appended records are kept in a separate file with this postfix.
+constexpr auto kJournalPostfix = 'j';
+
+enum class WriteType : uchar {
+	Replace,
+	Append,
+	ClearAppended,
+};
+
 struct WriteEntry {
 	QString basePath;
 	QString base;
 	QByteArray data;
 	QByteArray md5;
+	WriteType type = WriteType::Replace;
 };
 
 class WriteManager final {
@@ -45,6 +55,7 @@ private:
 	void writeScheduled();
 	bool writeOneScheduledNow();
 	void writeNow(WriteEntry &&entry);
+	void appendNow(const WriteEntry &entry);
 
 	template <typename File>
 	[[nodiscard]] bool open(File &file, const WriteEntry &entry, char postfix);
@@ -77,7 +88,13 @@ WriteManager::WriteManager(crl::weak_on_thread<WriteManager> weak)
 }
 
 void WriteManager::write(WriteEntry &&entry) {
-	const auto i = ranges::find(_scheduled, entry.base, &WriteEntry::base);
+	// Appended records must be written in order, only replaces are merged.
+	const auto i = (entry.type == WriteType::Replace)
+		? ranges::find_if(_scheduled, [&](const WriteEntry &scheduled) {
+			return (scheduled.type == WriteType::Replace)
+				&& (scheduled.base == entry.base);
+		})
+		: end(_scheduled);
 	if (i == end(_scheduled)) {
 		_scheduled.push_back(std::move(entry));
 	} else {
@@ -87,7 +104,11 @@ void WriteManager::write(WriteEntry &&entry) {
 }
 
 void WriteManager::writeSync(WriteEntry &&entry) {
-	const auto i = ranges::find(_scheduled, entry.base, &WriteEntry::base);
+	Expects(entry.type == WriteType::Replace);
+
+	const auto i = ranges::find_if(_scheduled, [&](const WriteEntry &e) {
+		return (e.type == WriteType::Replace) && (e.base == entry.base);
+	});
 	if (i != end(_scheduled)) {
 		_scheduled.erase(i);
 	}
@@ -95,6 +116,13 @@ void WriteManager::writeSync(WriteEntry &&entry) {
 }
 
 void WriteManager::writeNow(WriteEntry &&entry) {
+	if (entry.type == WriteType::Append) {
+		appendNow(entry);
+		return;
+	} else if (entry.type == WriteType::ClearAppended) {
+		QFile::remove(path(entry, kJournalPostfix));
+		return;
+	}
 	const auto path = [&](char postfix) {
 		return this->path(entry, postfix);
 	};
@@ -135,6 +163,25 @@ void WriteManager::writeNow(WriteEntry &&entry) {
 	}
 }
 
+void WriteManager::appendNow(const WriteEntry &entry) {
+	const auto name = path(entry, kJournalPostfix);
+	QFile file(name);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		const auto dir = QDir(entry.basePath);
+		if (dir.exists()
+			|| !QDir().mkpath(dir.absolutePath())
+			|| !file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+			LOG(("Storage Error: Could not open '%1' for appending."
+				).arg(name));
+			return;
+		}
+	}
+	if (file.write(entry.data) != entry.data.size()) {
+		LOG(("Storage Error: Could not append to '%1'.").arg(name));
+	}
+	base::Platform::FlushFileData(file);
+}
+
 void WriteManager::writeSyncAll() {
 	while (writeOneScheduledNow()) {
 	}
@@ -262,6 +309,10 @@ bool KeyAlreadyUsed(QString &name) {
 	if (QFileInfo::exists(name)) {
 		return true;
 	}
+	name[name.size() - 1] = kJournalPostfix;
+	if (QFileInfo::exists(name)) {
+		return true;
+	}
 	return false;
 }
 
@@ -288,6 +339,8 @@ void ClearKey(const FileKey &key, const QString &basePath) {
 	QFile::remove(name);
 	name[name.size() - 1] = 's';
 	QFile::remove(name);
+	name[name.size() - 1] = kJournalPostfix;
+	QFile::remove(name);
 }
 
 bool CheckStreamStatus(QDataStream &stream) {
@@ -665,6 +718,62 @@ bool ReadEncryptedFile(
 	return ReadEncryptedFile(result, ToFilePart(fkey), basePath, key);
 }
 
+void AppendEncrypted(
+		const FileKey &fkey,
+		const QString &basePath,
+		EncryptedDescriptor &data,
+		const MTP::AuthKeyPtr &key) {
+	auto record = QByteArray();
+	{
+		QDataStream stream(&record, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_1);
+		stream << PrepareEncrypted(data, key);
+	}
+	Manager.write({
+		.basePath = basePath,
+		.base = basePath + ToFilePart(fkey),
+		.data = std::move(record),
+		.type = WriteType::Append,
+	});
+}
+
+void ClearAppended(const FileKey &fkey, const QString &basePath) {
+	Manager.write({
+		.basePath = basePath,
+		.base = basePath + ToFilePart(fkey),
+		.type = WriteType::ClearAppended,
+	});
+}
+
+std::vector<QByteArray> ReadEncryptedAppended(
+		const FileKey &fkey,
+		const QString &basePath,
+		const MTP::AuthKeyPtr &key) {
+	QFile f(basePath + ToFilePart(fkey) + kJournalPostfix);
+	if (!f.open(QIODevice::ReadOnly)) {
+		return {};
+	}
+	QDataStream stream(&f);
+	stream.setVersion(QDataStream::Qt_5_1);
+
+	// A broken tail is possible after a crash, just stop reading there.
+	auto result = std::vector<QByteArray>();
+	while (!stream.atEnd()) {
+		QByteArray encrypted;
+		stream >> encrypted;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("App Info: broken record in '%1'").arg(f.fileName()));
+			break;
+		}
+		EncryptedDescriptor data;
+		if (!DecryptLocal(data, encrypted, key)) {
+			break;
+		}
+		result.push_back(data.data.mid(sizeof(uint32)));
+	}
+	return result;
+}
+
 void Sync() {
 	Manager.sync();
 }
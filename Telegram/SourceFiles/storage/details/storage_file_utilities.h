@@ -106,6 +106,19 @@ bool ReadEncryptedFile(
 	const QString &basePath,
 	const MTP::AuthKeyPtr &key);
 
+// Encrypted records appended to a separate file next to the key file,
+// they are removed together with the key in ClearKey().
+void AppendEncrypted(
+	const FileKey &fkey,
+	const QString &basePath,
+	EncryptedDescriptor &data,
+	const MTP::AuthKeyPtr &key);
+void ClearAppended(const FileKey &fkey, const QString &basePath);
+[[nodiscard]] std::vector<QByteArray> ReadEncryptedAppended(
+	const FileKey &fkey,
+	const QString &basePath,
+	const MTP::AuthKeyPtr &key);
+
 void Sync();
 void Finish();
 
@@ -22,6 +22,7 @@ namespace {
 constexpr auto kKillSessionTimeout = 15 * crl::time(1000);
 constexpr auto kStartWaitedInSession = 4 * kDownloadPartSize;
 constexpr auto kMaxWaitedInSession = 16 * kDownloadPartSize;
+constexpr auto kMaxWaitedInSessionLarge = 8 * kMaxDownloadPartSize;
 constexpr auto kStartSessionsCount = 1;
 constexpr auto kMaxSessionsCount = 8;
 constexpr auto kMaxTrackedSessionRemoves = 64;
@@ -32,12 +33,22 @@ constexpr auto kMaxTrackedSuccesses = kRetryAddSessionSuccesses
 constexpr auto kRemoveSessionAfterTimeouts = 4;
 constexpr auto kResetDownloadPrioritiesTimeout = crl::time(200);
 constexpr auto kBadRequestDurationThreshold = 8 * crl::time(1000);
+constexpr auto kIncreasePartSizeSuccesses = 4;
+constexpr auto kIncreasePartSizeThroughput = 4 * 1024 * 1024; // Per second.
+constexpr auto kThroughputSmoothing = 4;
 
 // Each (session remove by timeouts) we wait for time:
 // kRetryAddSessionTimeout * max(removesCount, kMaxTrackedSessionRemoves)
 // and for successes in all remaining sessions:
 // kRetryAddSessionSuccesses * max(removesCount, kMaxTrackedSessionRemoves)
 
+[[nodiscard]] int MaxWaitedInSession(int partSize) {
+	return std::clamp(
+		16 * partSize,
+		kMaxWaitedInSession,
+		kMaxWaitedInSessionLarge);
+}
+
 } // namespace
 
 void DownloadManagerMtproto::Queue::enqueue(
@@ -114,7 +125,8 @@ DownloadManagerMtproto::DcSessionBalanceData::DcSessionBalanceData()
 }
 
 DownloadManagerMtproto::DcBalanceData::DcBalanceData()
-: sessions(kStartSessionsCount) {
+: sessions(kStartSessionsCount)
+, partSize(kDownloadPartSize) {
 }
 
 DownloadManagerMtproto::DownloadManagerMtproto(not_null<ApiWrap*> api)
@@ -137,6 +149,7 @@ DownloadManagerMtproto::~DownloadManagerMtproto() {
 
 void DownloadManagerMtproto::enqueue(not_null<Task*> task, int priority) {
 	const auto dcId = task->dcId();
+	api().instance().warmMediaSessions(dcId);
 	auto &queue = _queues[dcId];
 	queue.enqueue(task, priority);
 	if (!_resetGenerationTimer.isActive()) {
@@ -173,6 +186,21 @@ void DownloadManagerMtproto::checkSendNext(MTP::DcId dcId, Queue &queue) {
 	}
 }
 
+void DownloadManagerMtproto::countThroughput(
+		const DcBalanceData &dc,
+		int amountAtRequestStart,
+		crl::time duration) {
+	// Each session was receiving amountAtRequestStart bytes in parallel.
+	const auto sample = int64(amountAtRequestStart)
+		* crl::time(1000)
+		* int64(dc.sessions.size())
+		/ std::max(duration, crl::time(1));
+	_throughput = _throughput
+		? ((_throughput * (kThroughputSmoothing - 1) + sample)
+			/ kThroughputSmoothing)
+		: sample;
+}
+
 void DownloadManagerMtproto::checkSendNextAfterSuccess(MTP::DcId dcId) {
 	checkSendNext(dcId, _queues[dcId]);
 }
@@ -184,7 +212,7 @@ bool DownloadManagerMtproto::trySendNextPart(MTP::DcId dcId, Queue &queue) {
 		const auto proj = [](const DcSessionBalanceData &data) {
 			return (data.requested < data.maxWaitedAmount)
 				? data.requested
-				: kMaxWaitedInSession;
+				: kMaxWaitedInSessionLarge;
 		};
 		const auto j = ranges::min_element(sessions, ranges::less(), proj);
 		return (j->requested + kDownloadPartSize <= j->maxWaitedAmount)
@@ -194,9 +222,15 @@ bool DownloadManagerMtproto::trySendNextPart(MTP::DcId dcId, Queue &queue) {
 	if (bestIndex < 0) {
 		return false;
 	}
+	const auto &session = sessions[bestIndex];
+	auto maxLimit = balanceData.partSize;
+	while (maxLimit > kDownloadPartSize
+		&& session.requested + maxLimit > session.maxWaitedAmount) {
+		maxLimit /= 2;
+	}
 	const auto onlyHighestPriority = (balanceData.totalRequested > 0);
 	if (const auto task = queue.nextTask(onlyHighestPriority)) {
-		task->loadPart(bestIndex);
+		task->loadPart(bestIndex, maxLimit);
 		return true;
 	}
 	return false;
@@ -229,6 +263,7 @@ int DownloadManagerMtproto::changeRequestedAmount(
 void DownloadManagerMtproto::requestSucceeded(
 		MTP::DcId dcId,
 		int index,
+		int limit,
 		int amountAtRequestStart,
 		crl::time timeAtRequestStart) {
 	using namespace rpl::mappers;
@@ -251,6 +286,7 @@ void DownloadManagerMtproto::requestSucceeded(
 	if (overloaded) {
 		return;
 	}
+	countThroughput(dc, amountAtRequestStart, duration);
 
 	if (duration >= kBadRequestDurationThreshold) {
 		DEBUG_LOG(("Duration too large, signaling time out."));
@@ -259,16 +295,29 @@ void DownloadManagerMtproto::requestSucceeded(
 		});
 		return;
 	}
-	if (amountAtRequestStart == data.maxWaitedAmount
-		&& data.maxWaitedAmount < kMaxWaitedInSession) {
+	const auto maxWaited = MaxWaitedInSession(dc.partSize);
+	if (amountAtRequestStart + kDownloadPartSize > data.maxWaitedAmount
+		&& data.maxWaitedAmount < maxWaited) {
 		data.maxWaitedAmount = std::min(
-			data.maxWaitedAmount + kDownloadPartSize,
-			kMaxWaitedInSession);
+			data.maxWaitedAmount + dc.partSize,
+			maxWaited);
 		DEBUG_LOG(("Download (%1,%2) increased max waited amount %3."
 			).arg(dcId
 			).arg(index
 			).arg(data.maxWaitedAmount));
 	}
+
+	// All the bytes requested in this session at the request start were
+	// received during its duration, that gives us the session throughput.
+	const auto fast = (limit >= dc.partSize)
+		&& (int64(amountAtRequestStart) * crl::time(1000)
+			>= int64(kIncreasePartSizeThroughput)
+				* std::max(duration, crl::time(1)));
+	if (!fast) {
+		dc.fastSuccesses = 0;
+	} else if (++dc.fastSuccesses >= kIncreasePartSizeSuccesses) {
+		increasePartSize(dc, dcId);
+	}
 	data.successes = std::min(data.successes + 1, kMaxTrackedSuccesses);
 	const auto notEnough = ranges::any_of(
 		dc.sessions,
@@ -298,6 +347,38 @@ void DownloadManagerMtproto::requestSucceeded(
 		).arg(dc.sessions.size()));
 }
 
+void DownloadManagerMtproto::increasePartSize(
+		DcBalanceData &dc,
+		MTP::DcId dcId) {
+	dc.fastSuccesses = 0;
+	if (dc.partSize >= kMaxDownloadPartSize) {
+		return;
+	}
+	dc.partSize *= 2;
+	DEBUG_LOG(("Download (%1) increased part size %2."
+		).arg(dcId
+		).arg(dc.partSize));
+}
+
+void DownloadManagerMtproto::decreasePartSize(
+		DcBalanceData &dc,
+		MTP::DcId dcId) {
+	dc.fastSuccesses = 0;
+	if (dc.partSize <= kDownloadPartSize) {
+		return;
+	}
+	dc.partSize /= 2;
+	const auto maxWaited = MaxWaitedInSession(dc.partSize);
+	for (auto &session : dc.sessions) {
+		session.maxWaitedAmount = std::min(
+			session.maxWaitedAmount,
+			maxWaited);
+	}
+	DEBUG_LOG(("Download (%1) decreased part size %2."
+		).arg(dcId
+		).arg(dc.partSize));
+}
+
 int DownloadManagerMtproto::chooseSessionIndex(MTP::DcId dcId) const {
 	const auto i = _balanceData.find(dcId);
 	Assert(i != end(_balanceData));
@@ -322,6 +403,7 @@ void DownloadManagerMtproto::sessionTimedOut(MTP::DcId dcId, int index) {
 	for (auto &session : dc.sessions) {
 		session.successes = 0;
 	}
+	decreasePartSize(dc, dcId);
 	if (dc.sessions.size() == kStartSessionsCount
 		|| ++dc.timeouts < kRemoveSessionAfterTimeouts) {
 		return;
@@ -350,9 +432,10 @@ void DownloadManagerMtproto::removeSession(MTP::DcId dcId) {
 	auto &session = dc.sessions.back();
 
 	// Make sure we don't send anything to that session while redirecting.
-	session.requested += kMaxWaitedInSession * kMaxSessionsCount;
+	session.requested += kMaxWaitedInSessionLarge * kMaxSessionsCount;
 	queue.removeSession(index);
-	Assert(session.requested == kMaxWaitedInSession * kMaxSessionsCount);
+	Assert(session.requested
+		== kMaxWaitedInSessionLarge * kMaxSessionsCount);
 
 	dc.sessions.pop_back();
 	api().instance().killSession(MTP::downloadDcId(dcId, index));
@@ -475,20 +558,30 @@ void DownloadMtprotoTask::refreshFileReferenceFrom(
 	}
 }
 
-void DownloadMtprotoTask::loadPart(int sessionIndex) {
-	makeRequest({ takeNextRequestOffset(), sessionIndex });
+void DownloadMtprotoTask::loadPart(int sessionIndex, int maxLimit) {
+	const auto part = takeNextRequest(maxLimit);
+	makeRequest({ part.offset, sessionIndex, part.limit });
+}
+
+auto DownloadMtprotoTask::takeNextRequest(int maxLimit) -> PartRequest {
+	return { takeNextRequestOffset(), kDownloadPartSize };
 }
 
 void DownloadMtprotoTask::removeSession(int sessionIndex) {
 	struct Redirect {
 		mtpRequestId requestId = 0;
 		int64 offset = 0;
+		int limit = 0;
 	};
 	auto redirect = std::vector<Redirect>();
 	for (const auto &[requestId, requestData] : _sentRequests) {
 		if (requestData.sessionIndex == sessionIndex) {
 			redirect.reserve(_sentRequests.size());
-			redirect.push_back({ requestId, requestData.offset });
+			redirect.push_back({
+				requestId,
+				requestData.offset,
+				requestData.limit,
+			});
 		}
 	}
 	for (auto &[requestData, bytes] : _cdnUncheckedParts) {
@@ -498,13 +591,13 @@ void DownloadMtprotoTask::removeSession(int sessionIndex) {
 			requestData.sessionIndex = newIndex;
 		}
 	}
-	for (const auto &[requestId, offset] : redirect) {
+	for (const auto &[requestId, offset, limit] : redirect) {
 		const auto needMakeRequest = (requestId != _cdnHashesRequestId);
 		cancelRequest(requestId);
 		if (needMakeRequest) {
 			const auto newIndex = _owner->chooseSessionIndex(dcId());
 			Assert(newIndex < sessionIndex);
-			makeRequest({ offset, newIndex });
+			makeRequest({ offset, newIndex, limit });
 		}
 	}
 }
@@ -512,7 +605,7 @@ void DownloadMtprotoTask::removeSession(int sessionIndex) {
 mtpRequestId DownloadMtprotoTask::sendRequest(
 		const RequestData &requestData) {
 	const auto offset = requestData.offset;
-	const auto limit = Storage::kDownloadPartSize;
+	const auto limit = requestData.limit;
 	const auto shiftedDcId = MTP::downloadDcId(
 		_cdnDcId ? _cdnDcId : dcId(),
 		requestData.sessionIndex);
@@ -603,13 +696,16 @@ void DownloadMtprotoTask::requestMoreCdnFileHashes() {
 		return;
 	}
 
-	const auto requestData = _cdnUncheckedParts.cbegin()->first;
+	const auto &[requestData, unchecked] = *_cdnUncheckedParts.cbegin();
+	const auto missing = firstMissingCdnFileHash(
+		requestData.offset,
+		unchecked.size());
 	const auto shiftedDcId = MTP::downloadDcId(
 		dcId(),
 		requestData.sessionIndex);
 	_cdnHashesRequestId = api().request(MTPupload_GetCdnFileHashes(
 		MTP_bytes(_cdnToken),
-		MTP_long(requestData.offset)
+		MTP_long((missing >= 0) ? missing : requestData.offset)
 	)).done([=](const MTPVector<MTPFileHash> &result, mtpRequestId id) {
 		getCdnFileHashesDone(result, id);
 	}).fail([=](const MTP::Error &error, mtpRequestId id) {
@@ -724,18 +820,46 @@ void DownloadMtprotoTask::cdnPartLoaded(const MTPupload_CdnFile &result, mtpRequ
 DownloadMtprotoTask::CheckCdnHashResult DownloadMtprotoTask::checkCdnFileHash(
 		int64 offset,
 		bytes::const_span buffer) {
-	const auto cdnFileHashIt = _cdnFileHashes.find(offset);
-	if (cdnFileHashIt == _cdnFileHashes.cend()) {
-		return CheckCdnHashResult::NoHash;
-	}
-	const auto realHash = openssl::Sha256(buffer);
-	const auto receivedHash = bytes::make_span(cdnFileHashIt->second.hash);
-	if (bytes::compare(realHash, receivedHash)) {
-		return CheckCdnHashResult::Invalid;
+	// A large part may span several hashed chunks, check each of them.
+	auto checked = 0;
+	const auto size = int(buffer.size());
+	while (checked < size) {
+		const auto cdnFileHashIt = _cdnFileHashes.find(offset + checked);
+		if (cdnFileHashIt == _cdnFileHashes.cend()) {
+			return CheckCdnHashResult::NoHash;
+		}
+		const auto limit = cdnFileHashIt->second.limit;
+		if (limit <= 0) {
+			return CheckCdnHashResult::Invalid;
+		}
+		const auto chunk = std::min(size - checked, limit);
+		const auto realHash = openssl::Sha256(
+			buffer.subspan(checked, chunk));
+		const auto receivedHash = bytes::make_span(
+			cdnFileHashIt->second.hash);
+		if (bytes::compare(realHash, receivedHash)) {
+			return CheckCdnHashResult::Invalid;
+		}
+		checked += chunk;
 	}
 	return CheckCdnHashResult::Good;
 }
 
+int64 DownloadMtprotoTask::firstMissingCdnFileHash(
+		int64 offset,
+		int size) const {
+	auto checked = 0;
+	while (checked < size) {
+		const auto cdnFileHashIt = _cdnFileHashes.find(offset + checked);
+		if (cdnFileHashIt == _cdnFileHashes.cend()
+			|| cdnFileHashIt->second.limit <= 0) {
+			return offset + checked;
+		}
+		checked += cdnFileHashIt->second.limit;
+	}
+	return -1;
+}
+
 void DownloadMtprotoTask::reuploadDone(
 		const MTPVector<MTPFileHash> &result,
 		mtpRequestId requestId) {
@@ -754,7 +878,9 @@ void DownloadMtprotoTask::getCdnFileHashesDone(
 	const auto requestData = finishSentRequest(
 		requestId,
 		FinishRequestReason::Redirect);
+	const auto wasHashes = _cdnFileHashes.size();
 	addCdnHashes(result.v);
+	const auto someMoreHashes = (_cdnFileHashes.size() > wasHashes);
 	auto someMoreChecked = false;
 	for (auto i = _cdnUncheckedParts.begin(); i != _cdnUncheckedParts.cend();) {
 		const auto uncheckedData = i->first;
@@ -786,7 +912,7 @@ void DownloadMtprotoTask::getCdnFileHashesDone(
 		default: Unexpected("Result of checkCdnFileHash()");
 		}
 	}
-	if (!someMoreChecked) {
+	if (!someMoreChecked && !someMoreHashes) {
 		LOG(("API Error: "
 			"Could not find cdnFileHash for offset %1 "
 			"after getCdnFileHashes request."
@@ -807,7 +933,7 @@ void DownloadMtprotoTask::placeSentRequest(
 	const auto amount = _owner->changeRequestedAmount(
 		dcId(),
 		requestData.sessionIndex,
-		Storage::kDownloadPartSize);
+		requestData.limit);
 	const auto &[i, ok1] = _sentRequests.emplace(requestId, requestData);
 	const auto &[j, ok2] = _requestByOffset.emplace(
 		requestData.offset,
@@ -851,7 +977,7 @@ auto DownloadMtprotoTask::finishSentRequest(
 	_owner->changeRequestedAmount(
 		dcId(),
 		result.sessionIndex,
-		-Storage::kDownloadPartSize);
+		-result.limit);
 	_sentRequests.erase(it);
 	const auto ok = _requestByOffset.remove(result.offset);
 
@@ -863,6 +989,7 @@ auto DownloadMtprotoTask::finishSentRequest(
 		_owner->requestSucceeded(
 			dcId(),
 			result.sessionIndex,
+			result.limit,
 			result.requestedInSession,
 			result.sent);
 	}
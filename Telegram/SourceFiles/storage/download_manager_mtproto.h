@@ -19,11 +19,11 @@ class Error;
 
 namespace Storage {
 
-// Different part sizes are not supported for now :(
-// Because we start downloading with some part size
-// and then we get a CDN-redirect where we support only
-// fixed part size download for hash checking.
+// Offsets are always aligned to the base part size, larger parts are
+// requested only by tasks that support them, when the dc is fast enough.
+// CDN file hashes are checked for each hashed chunk inside a larger part.
 constexpr auto kDownloadPartSize = 128 * 1024;
+constexpr auto kMaxDownloadPartSize = 1024 * 1024;
 
 class DownloadMtprotoTask;
 
@@ -52,11 +52,17 @@ public:
 	void requestSucceeded(
 		MTP::DcId dcId,
 		int index,
+		int limit,
 		int amountAtRequestStart,
 		crl::time timeAtRequestStart);
 	void checkSendNextAfterSuccess(MTP::DcId dcId);
 	[[nodiscard]] int chooseSessionIndex(MTP::DcId dcId) const;
 
+	// Recently measured download speed in bytes per second, zero if none.
+	[[nodiscard]] int64 throughput() const {
+		return _throughput;
+	}
+
 	void notifyNonPremiumDelay(DocumentId id) {
 		_nonPremiumDelays.fire_copy(id);
 	}
@@ -98,6 +104,8 @@ private:
 		int sessionRemoveTimes = 0;
 		int timeouts = 0; // Since all sessions had successes >= required.
 		int totalRequested = 0;
+		int partSize = 0;
+		int fastSuccesses = 0; // Since last part size change in this dc.
 	};
 
 	void checkSendNext();
@@ -110,7 +118,13 @@ private:
 	void killSessions(MTP::DcId dcId);
 
 	void resetGeneration();
+	void increasePartSize(DcBalanceData &dc, MTP::DcId dcId);
+	void decreasePartSize(DcBalanceData &dc, MTP::DcId dcId);
 	void sessionTimedOut(MTP::DcId dcId, int index);
+	void countThroughput(
+		const DcBalanceData &dc,
+		int amountAtRequestStart,
+		crl::time duration);
 	void removeSession(MTP::DcId dcId);
 
 	const not_null<ApiWrap*> _api;
@@ -119,6 +133,7 @@ private:
 	rpl::event_stream<DocumentId> _nonPremiumDelays;
 
 	base::flat_map<MTP::DcId, DcBalanceData> _balanceData;
+	int64 _throughput = 0;
 	base::Timer _resetGenerationTimer;
 
 	base::flat_map<MTP::DcId, crl::time> _killSessionsWhen;
@@ -155,7 +170,7 @@ public:
 	[[nodiscard]] const Location &location() const;
 
 	[[nodiscard]] virtual bool readyToRequest() const = 0;
-	void loadPart(int sessionIndex);
+	void loadPart(int sessionIndex, int maxLimit);
 	void removeSession(int sessionIndex);
 
 	void refreshFileReferenceFrom(
@@ -164,6 +179,11 @@ public:
 		const QByteArray &current);
 
 protected:
+	struct PartRequest {
+		int64 offset = 0;
+		int limit = kDownloadPartSize;
+	};
+
 	[[nodiscard]] bool haveSentRequests() const;
 	[[nodiscard]] bool haveSentRequestForOffset(int64 offset) const;
 	void cancelAllRequests();
@@ -180,6 +200,7 @@ private:
 	struct RequestData {
 		int64 offset = 0;
 		mutable int sessionIndex = 0;
+		int limit = kDownloadPartSize;
 		int requestedInSession = 0;
 		crl::time sent = 0;
 
@@ -206,6 +227,7 @@ private:
 
 	// Called only if readyToRequest() == true.
 	[[nodiscard]] virtual int64 takeNextRequestOffset() = 0;
+	[[nodiscard]] virtual PartRequest takeNextRequest(int maxLimit);
 	virtual bool feedPart(int64 offset, const QByteArray &bytes) = 0;
 	virtual bool setWebFileSizeHook(int64 size);
 	virtual void cancelOnFail() = 0;
@@ -260,6 +282,9 @@ private:
 	[[nodiscard]] CheckCdnHashResult checkCdnFileHash(
 		int64 offset,
 		bytes::const_span buffer);
+	[[nodiscard]] int64 firstMissingCdnFileHash(
+		int64 offset,
+		int size) const;
 
 	void subscribeToNonPremiumLimit();
 
@@ -142,6 +142,25 @@ int64 mtpFileLoader::takeNextRequestOffset() {
 	return result;
 }
 
+auto mtpFileLoader::takeNextRequest(int maxLimit) -> PartRequest {
+	Expects(readyToRequest());
+
+	// Only upload.getFile supports larger parts, they should be aligned
+	// and never cross a 1 MB boundary, so we keep power-of-two sizes.
+	const auto offset = _nextRequestOffset;
+	auto limit = Storage::kDownloadPartSize;
+	if (v::is<StorageFileLocation>(location().data)) {
+		while (limit < maxLimit
+			&& !(offset % (limit * 2))
+			&& _fullSize
+			&& offset + limit < _loadSize) {
+			limit *= 2;
+		}
+	}
+	_nextRequestOffset += limit;
+	return { offset, limit };
+}
+
 bool mtpFileLoader::feedPart(int64 offset, const QByteArray &bytes) {
 	const auto buffer = bytes::make_span(bytes);
 	if (!writeResultPart(offset, buffer)) {
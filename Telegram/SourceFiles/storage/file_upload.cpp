@@ -23,12 +23,20 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 #include "apiwrap.h"
 
+#include <crl/crl_object_on_queue.h>
+
 namespace Storage {
 namespace {
 
 // max 1mb uploaded at the same time in each session
 constexpr auto kMaxUploadPerSession = 1024 * 1024;
 
+// up to 4mb in each session, if its requests are done fast
+constexpr auto kMaxUploadPerSessionLarge = 4 * 1024 * 1024;
+
+// 8mb of document parts are read and hashed in background in advance
+constexpr auto kDocumentReadAheadSize = 8 * 1024 * 1024;
+
 constexpr auto kDocumentMaxPartsCountDefault = 4000;
 
 // 32kb for tiny document ( < 1mb )
@@ -69,6 +77,109 @@ constexpr auto kAcceptAsFastIfTotalAtLeast = 512 * 1024;
 
 } // namespace
 
+struct Uploader::ReadPart {
+	uint64 readerId = 0;
+	QByteArray bytes;
+	QByteArray md5;
+	bool failed = false;
+};
+
+class Uploader::PartsReader final {
+public:
+	PartsReader(
+		crl::weak_on_queue<PartsReader> weak,
+		uint64 id,
+		const QString &filepath,
+		const QByteArray &content,
+		int partSize,
+		int partsCount,
+		bool computeMd5,
+		Fn<void(ReadPart)> done);
+
+	void read(int count);
+
+private:
+	[[nodiscard]] QByteArray readPart();
+
+	const uint64 _id = 0;
+	const QString _filepath;
+	const QByteArray _content;
+	const int _partSize = 0;
+	const int _partsCount = 0;
+	const bool _computeMd5 = false;
+	const Fn<void(ReadPart)> _done;
+
+	std::unique_ptr<QFile> _file;
+	HashMd5 _md5;
+	int _partsRead = 0;
+	bool _failed = false;
+
+};
+
+Uploader::PartsReader::PartsReader(
+	crl::weak_on_queue<PartsReader>,
+	uint64 id,
+	const QString &filepath,
+	const QByteArray &content,
+	int partSize,
+	int partsCount,
+	bool computeMd5,
+	Fn<void(ReadPart)> done)
+: _id(id)
+, _filepath(filepath)
+, _content(content)
+, _partSize(partSize)
+, _partsCount(partsCount)
+, _computeMd5(computeMd5)
+, _done(std::move(done)) {
+}
+
+void Uploader::PartsReader::read(int count) {
+	while (count-- > 0 && !_failed && _partsRead < _partsCount) {
+		auto bytes = readPart();
+		if (bytes.isEmpty()) {
+			_failed = true;
+			_done({ .readerId = _id, .failed = true });
+			return;
+		}
+		if (_computeMd5) {
+			_md5.feed(bytes.constData(), bytes.size());
+		}
+		auto md5 = QByteArray();
+		if (++_partsRead == _partsCount && _computeMd5) {
+			md5 = QByteArray(32, Qt::Uninitialized);
+			hashMd5Hex(_md5.result(), md5.data());
+		}
+		_done({
+			.readerId = _id,
+			.bytes = std::move(bytes),
+			.md5 = std::move(md5),
+		});
+	}
+}
+
+QByteArray Uploader::PartsReader::readPart() {
+	const auto checked = [&](QByteArray result) {
+		if (result.isEmpty()
+			|| (result.size() > _partSize)
+			|| ((result.size() < _partSize
+				&& _partsRead + 1 != _partsCount))) {
+			return QByteArray();
+		}
+		return result;
+	};
+	if (!_content.isEmpty()) {
+		const auto offset = _partsRead * _partSize;
+		return checked(_content.mid(offset, _partSize));
+	} else if (!_file) {
+		_file = std::make_unique<QFile>(_filepath);
+		if (!_file->open(QIODevice::ReadOnly)) {
+			return QByteArray();
+		}
+	}
+	return checked(_file->read(_partSize));
+}
+
 struct Uploader::Entry {
 	Entry(FullMsgId itemId, const std::shared_ptr<FilePrepareResult> &file);
 
@@ -85,9 +196,12 @@ struct Uploader::Entry {
 	ushort partsSent = 0;
 	ushort partsWaiting = 0;
 
-	HashMd5 md5Hash;
+	std::unique_ptr<crl::object_on_queue<PartsReader>> docReader;
+	std::deque<QByteArray> docPartsReady;
+	QByteArray docMd5;
+	uint64 docReaderId = 0;
+	int docPartsRequested = 0;
 
-	std::unique_ptr<QFile> docFile;
 	int64 docSize = 0;
 	int64 docSentSize = 0;
 	int docPartSize = 0;
@@ -337,6 +451,7 @@ void Uploader::upload(
 		}
 	}
 	_queue.push_back({ itemId, file });
+	_api->instance().warmMediaSessions(_api->instance().mainDcId());
 	if (!_nextTimer.isActive()) {
 		maybeSend();
 	}
@@ -384,39 +499,68 @@ void Uploader::stopSessions() {
 			_api->instance().stopSession(MTP::uploadDcId(i));
 		}
 		_sentPerDcIndex.clear();
+		_windowPerDcIndex.clear();
 		_dcIndicesWithFastRequests.clear();
 	}
 }
 
-QByteArray Uploader::readDocPart(not_null<Entry*> entry) {
-	const auto checked = [&](QByteArray result) {
-		if ((entry->file->type == SendMediaType::File
-			|| entry->file->type == SendMediaType::ThemeFile
-			|| entry->file->type == SendMediaType::Audio
-			|| entry->file->type == SendMediaType::Round)
-			&& entry->docSize <= kUseBigFilesFrom) {
-			entry->md5Hash.feed(result.data(), result.size());
-		}
-		if (result.isEmpty()
-			|| (result.size() > entry->docPartSize)
-			|| ((result.size() < entry->docPartSize
-				&& entry->docPartsSent + 1 != entry->docPartsCount))) {
-			return QByteArray();
-		}
-		return result;
-	};
-	auto &content = entry->file->content;
-	if (!content.isEmpty()) {
-		const auto offset = entry->docPartsSent * entry->docPartSize;
-		return checked(content.mid(offset, entry->docPartSize));
-	} else if (!entry->docFile) {
-		const auto filepath = entry->file->filepath;
-		entry->docFile = std::make_unique<QFile>(filepath);
-		if (!entry->docFile->open(QIODevice::ReadOnly)) {
-			return QByteArray();
-		}
+void Uploader::readDocPartsAhead(not_null<Entry*> entry) {
+	if (!entry->docReader) {
+		static auto ReaderId = uint64();
+		const auto type = entry->file->type;
+		const auto computeMd5 = (type == SendMediaType::File
+			|| type == SendMediaType::ThemeFile
+			|| type == SendMediaType::Audio
+			|| type == SendMediaType::Round)
+			&& (entry->docSize <= kUseBigFilesFrom);
+		const auto weak = base::make_weak(this);
+		const auto itemId = entry->itemId;
+		entry->docReaderId = ++ReaderId;
+		entry->docReader = std::make_unique<
+			crl::object_on_queue<PartsReader>
+		>(
+			entry->docReaderId,
+			entry->file->filepath,
+			entry->file->content,
+			entry->docPartSize,
+			int(entry->docPartsCount),
+			computeMd5,
+			[=](ReadPart &&part) {
+				crl::on_main(weak, [=, part = std::move(part)] {
+					docPartRead(itemId, part);
+				});
+			});
+	}
+	const auto inMemory = entry->docPartsRequested - entry->docPartsSent;
+	const auto limit = std::max(
+		kDocumentReadAheadSize / entry->docPartSize,
+		1);
+	const auto count = std::min(
+		limit - inMemory,
+		int(entry->docPartsCount) - entry->docPartsRequested);
+	if (count > 0) {
+		entry->docPartsRequested += count;
+		entry->docReader->with([=](PartsReader &reader) {
+			reader.read(count);
+		});
+	}
+}
+
+void Uploader::docPartRead(FullMsgId itemId, const ReadPart &part) {
+	const auto i = ranges::find(_queue, itemId, &Entry::itemId);
+	if (i == end(_queue) || i->docReaderId != part.readerId) {
+		return;
+	} else if (part.failed) {
+		failed(itemId);
+		return;
+	}
+	i->docPartsReady.push_back(part.bytes);
+	if (!part.md5.isEmpty()) {
+		i->docMd5 = part.md5;
+	}
+	if (!_nextTimer.isActive()) {
+		maybeSend();
 	}
-	return checked(entry->docFile->read(entry->docPartSize));
 }
 
 bool Uploader::canAddDcIndex() const {
@@ -435,6 +579,7 @@ std::optional<uchar> Uploader::chooseDcIndexForNextRequest(
 	if (canAddDcIndex()) {
 		const auto result = int(_sentPerDcIndex.size());
 		_sentPerDcIndex.push_back(0);
+		_windowPerDcIndex.push_back(kMaxUploadPerSession);
 		_dcIndicesWithFastRequests.clear();
 		_latestDcIndexAdded = crl::now();
 
@@ -531,19 +676,21 @@ auto Uploader::sendDocPart(not_null<Entry*> entry, uchar dcIndex)
 	const auto itemId = entry->itemId;
 	const auto alreadySent = _sentPerDcIndex[dcIndex];
 	const auto willProbablyBeSent = entry->docPartSize;
-	if (alreadySent + willProbablyBeSent > kMaxUploadPerSession) {
+	if (alreadySent + willProbablyBeSent > _windowPerDcIndex[dcIndex]) {
 		return SendResult::DcIndexFull;
 	}
 
 	Assert(entry->docPartsSent < entry->docPartsCount);
 
-	const auto partBytes = readDocPart(entry);
-	if (partBytes.isEmpty()) {
-		failed(itemId);
-		return SendResult::Failed;
+	if (entry->docPartsReady.empty()) {
+		readDocPartsAhead(entry);
+		return SendResult::Waiting;
 	}
+	const auto partBytes = std::move(entry->docPartsReady.front());
+	entry->docPartsReady.pop_front();
 	const auto part = entry->docPartsSent++;
 	++entry->docPartsWaiting;
+	readDocPartsAhead(entry);
 
 	const auto send = [&](auto &&request, bool big) {
 		sendPreparedRequest(std::move(request), {
@@ -577,7 +724,7 @@ auto Uploader::sendSlicedPart(not_null<Entry*> entry, uchar dcIndex)
 	const auto itemId = entry->itemId;
 	const auto alreadySent = _sentPerDcIndex[dcIndex];
 	const auto willBeSent = entry->parts->at(entry->partsSent).size();
-	if (alreadySent + willBeSent >= kMaxUploadPerSession) {
+	if (alreadySent + willBeSent >= _windowPerDcIndex[dcIndex]) {
 		return SendResult::DcIndexFull;
 	}
 
@@ -623,7 +770,8 @@ void Uploader::maybeSend() {
 				return;
 			}
 			const auto result = sendPart(entry, dcIndex);
-			if (result == SendResult::DcIndexFull) {
+			if (result == SendResult::DcIndexFull
+				|| result == SendResult::Waiting) {
 				return;
 			} else if (result == SendResult::Success) {
 				break;
@@ -725,6 +873,11 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 
 	if (slowish) {
 		_dcIndicesWithFastRequests.clear();
+		if (_windowPerDcIndex[request.dcIndex] > kMaxUploadPerSession) {
+			_windowPerDcIndex[request.dcIndex] = kMaxUploadPerSession;
+			DEBUG_LOG(("Uploader: Slow-ish request, reset window of %1."
+				).arg(request.dcIndex));
+		}
 		if (slow) {
 			const auto elapsed = (now - _latestDcIndexRemoved);
 			const auto remove = (elapsed >= kWaitForNormalizeTimeout);
@@ -745,6 +898,16 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 				).arg(request.dcIndex
 				).arg(_sentPerDcIndex.size()));
 		}
+
+		// The window was almost full and still the request was fast.
+		auto &window = _windowPerDcIndex[request.dcIndex];
+		if (window < kMaxUploadPerSessionLarge
+			&& (request.queued + bytes) * 2 >= window) {
+			window = std::min(window * 2, kMaxUploadPerSessionLarge);
+			DEBUG_LOG(("Uploader: Grow window of %1 to %2."
+				).arg(request.dcIndex
+				).arg(window));
+		}
 	}
 
 	if (request.docPart) {
@@ -807,6 +970,7 @@ void Uploader::removeDcIndex() {
 	}
 	Assert(_sentPerDcIndex.back() == 0);
 	_sentPerDcIndex.pop_back();
+	_windowPerDcIndex.pop_back();
 	_dcIndicesWithFastRequests.remove(dcIndex);
 	_api->instance().stopSession(MTP::uploadDcId(dcIndex));
 	DEBUG_LOG(("Uploader: Removed dc index %1.").arg(dcIndex));
@@ -867,9 +1031,7 @@ void Uploader::finishFront() {
 		|| entry.file->type == SendMediaType::ThemeFile
 		|| entry.file->type == SendMediaType::Audio
 		|| entry.file->type == SendMediaType::Round) {
-		QByteArray docMd5(32, Qt::Uninitialized);
-		hashMd5Hex(entry.md5Hash.result(), docMd5.data());
-
+		const auto docMd5 = entry.docMd5;
 		const auto file = (entry.docSize > kUseBigFilesFrom)
 			? MTP_inputFileBig(
 				MTP_long(entry.file->id),
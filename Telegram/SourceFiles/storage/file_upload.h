@@ -102,11 +102,14 @@ public:
 private:
 	struct Entry;
 	struct Request;
+	struct ReadPart;
+	class PartsReader;
 
 	enum class SendResult : uchar {
 		Success,
 		Failed,
 		DcIndexFull,
+		Waiting,
 	};
 
 	void maybeSend();
@@ -121,7 +124,8 @@ private:
 		-> SendResult;
 	[[nodiscard]] auto sendSlicedPart(not_null<Entry*> entry, uchar dcIndex)
 		-> SendResult;
-	[[nodiscard]] QByteArray readDocPart(not_null<Entry*> entry);
+	void readDocPartsAhead(not_null<Entry*> entry);
+	void docPartRead(FullMsgId itemId, const ReadPart &part);
 	void removeDcIndex();
 
 	template <typename Prepared>
@@ -156,6 +160,7 @@ private:
 
 	base::flat_map<mtpRequestId, Request> _requests;
 	std::vector<int> _sentPerDcIndex;
+	std::vector<int> _windowPerDcIndex;
 
 	// Fast requests since the latest dc index addition.
 	base::flat_set<uchar> _dcIndicesWithFastRequests;
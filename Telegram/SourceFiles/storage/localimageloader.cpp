@@ -222,7 +222,8 @@ int PhotoSideLimit() {
 	return PhotoSideLimit(SendLargePhotos.value());
 }
 
-TaskQueue::TaskQueue(crl::time stopTimeoutMs) {
+TaskQueue::TaskQueue(crl::time stopTimeoutMs, int workersLimit)
+: _workersLimit(std::max(workersLimit, 1)) {
 	if (stopTimeoutMs > 0) {
 		_stopTimer = new QTimer(this);
 		connect(_stopTimer, SIGNAL(timeout()), this, SLOT(stop()));
@@ -235,6 +236,7 @@ TaskId TaskQueue::addTask(std::unique_ptr<Task> &&task) {
 	const auto result = task->id();
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
+		_tasksOrder.push_back(result);
 		_tasksToProcess.push_back(std::move(task));
 	}
 
@@ -247,6 +249,7 @@ void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		for (auto &task : tasks) {
+			_tasksOrder.push_back(task->id());
 			_tasksToProcess.push_back(std::move(task));
 		}
 	}
@@ -255,16 +258,24 @@ void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
 }
 
 void TaskQueue::wakeThread() {
-	if (!_thread) {
-		_thread = new QThread();
+	const auto waiting = [&] {
+		QMutexLocker lock(&_tasksToProcessMutex);
+		return int(_tasksToProcess.size() + _tasksInProcess.size());
+	}();
+	const auto needed = std::min(waiting, _workersLimit);
+	while (int(_threads.size()) < needed) {
+		const auto thread = new QThread();
 
-		_worker = new TaskQueueWorker(this);
-		_worker->moveToThread(_thread);
+		const auto worker = new TaskQueueWorker(this);
+		worker->moveToThread(thread);
 
-		connect(this, SIGNAL(taskAdded()), _worker, SLOT(onTaskAdded()));
-		connect(_worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
+		connect(this, SIGNAL(taskAdded()), worker, SLOT(onTaskAdded()));
+		connect(worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
 
-		_thread->start();
+		thread->start();
+
+		_threads.push_back(thread);
+		_workers.push_back(worker);
 	}
 	if (_stopTimer) _stopTimer->stop();
 	taskAdded();
@@ -280,15 +291,72 @@ void TaskQueue::cancelTask(TaskId id) {
 			queue.erase(i);
 		}
 	};
+	auto finishReady = false;
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		removeFrom(_tasksToProcess);
-		if (_taskInProcessId == id) {
-			_taskInProcessId = TaskId();
+		removeFrom(_tasksProcessed);
+		_tasksInProcess.erase(
+			ranges::remove(_tasksInProcess, id),
+			end(_tasksInProcess));
+		const auto i = ranges::find(_tasksOrder, id);
+		if (i != end(_tasksOrder)) {
+			// Tasks waiting for the cancelled one may be finished now.
+			const auto first = (i == begin(_tasksOrder));
+			_tasksOrder.erase(i);
+			finishReady = first && pushProcessedInOrder();
 		}
 	}
+	{
+		QMutexLocker lock(&_tasksToFinishMutex);
+		removeFrom(_tasksToFinish);
+	}
+	if (finishReady) {
+		crl::on_main(this, [=] {
+			onTaskProcessed();
+		});
+	}
+}
+
+std::unique_ptr<Task> TaskQueue::takeTaskToProcess() {
+	if (_tasksToProcess.empty()) {
+		return nullptr;
+	}
+	auto result = std::move(_tasksToProcess.front());
+	_tasksToProcess.pop_front();
+	_tasksInProcess.push_back(result->id());
+	return result;
+}
+
+bool TaskQueue::taskProcessed(std::unique_ptr<Task> task) {
+	const auto i = ranges::find(_tasksInProcess, task->id());
+	if (i == end(_tasksInProcess)) {
+		return false; // Cancelled while processing.
+	}
+	_tasksInProcess.erase(i);
+	_tasksProcessed.push_back(std::move(task));
+	return pushProcessedInOrder();
+}
+
+bool TaskQueue::pushProcessedInOrder() {
+	const auto proj = [](const std::unique_ptr<Task> &task) {
+		return task->id();
+	};
 	QMutexLocker lock(&_tasksToFinishMutex);
-	removeFrom(_tasksToFinish);
+	const auto wasEmpty = _tasksToFinish.empty();
+	while (!_tasksOrder.empty()) {
+		const auto i = ranges::find(
+			_tasksProcessed,
+			_tasksOrder.front(),
+			proj);
+		if (i == end(_tasksProcessed)) {
+			break;
+		}
+		_tasksToFinish.push_back(std::move(*i));
+		_tasksProcessed.erase(i);
+		_tasksOrder.pop_front();
+	}
+	return wasEmpty && !_tasksToFinish.empty();
 }
 
 void TaskQueue::onTaskProcessed() {
@@ -305,24 +373,34 @@ void TaskQueue::onTaskProcessed() {
 
 	if (_stopTimer) {
 		QMutexLocker lock(&_tasksToProcessMutex);
-		if (_tasksToProcess.empty() && !_taskInProcessId) {
+		if (_tasksToProcess.empty() && _tasksInProcess.empty()) {
 			_stopTimer->start();
 		}
 	}
 }
 
 void TaskQueue::stop() {
-	if (_thread) {
-		_thread->requestInterruption();
-		_thread->quit();
+	for (const auto thread : _threads) {
+		thread->requestInterruption();
+		thread->quit();
+	}
+	if (!_threads.empty()) {
 		DEBUG_LOG(("Waiting for taskThread to finish"));
-		_thread->wait();
-		delete base::take(_worker);
-		delete base::take(_thread);
+	}
+	for (const auto thread : _threads) {
+		thread->wait();
+	}
+	for (const auto worker : base::take(_workers)) {
+		delete worker;
+	}
+	for (const auto thread : base::take(_threads)) {
+		delete thread;
 	}
 	_tasksToProcess.clear();
+	_tasksProcessed.clear();
 	_tasksToFinish.clear();
-	_taskInProcessId = TaskId();
+	_tasksOrder.clear();
+	_tasksInProcess.clear();
 }
 
 TaskQueue::~TaskQueue() {
@@ -334,35 +412,26 @@ void TaskQueueWorker::onTaskAdded() {
 	if (_inTaskAdded) return;
 	_inTaskAdded = true;
 
-	bool someTasksLeft = false;
+	auto someTasksLeft = false;
 	do {
 		auto task = std::unique_ptr<Task>();
 		{
 			QMutexLocker lock(&_queue->_tasksToProcessMutex);
-			if (!_queue->_tasksToProcess.empty()) {
-				task = std::move(_queue->_tasksToProcess.front());
-				_queue->_tasksToProcess.pop_front();
-				_queue->_taskInProcessId = task->id();
-			}
+			task = _queue->takeTaskToProcess();
 		}
+		if (!task) {
+			break;
+		}
+		task->process();
 
-		if (task) {
-			task->process();
-			bool emitTaskProcessed = false;
-			{
-				QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
-				if (_queue->_taskInProcessId == task->id()) {
-					_queue->_taskInProcessId = TaskId();
-					someTasksLeft = !_queue->_tasksToProcess.empty();
-
-					QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
-					emitTaskProcessed = _queue->_tasksToFinish.empty();
-					_queue->_tasksToFinish.push_back(std::move(task));
-				}
-			}
-			if (emitTaskProcessed) {
-				taskProcessed();
-			}
+		auto emitTaskProcessed = false;
+		{
+			QMutexLocker lock(&_queue->_tasksToProcessMutex);
+			emitTaskProcessed = _queue->taskProcessed(std::move(task));
+			someTasksLeft = !_queue->_tasksToProcess.empty();
+		}
+		if (emitTaskProcessed) {
+			taskProcessed();
 		}
 		QCoreApplication::processEvents();
 	} while (someTasksLeft && !thread()->isInterruptionRequested());
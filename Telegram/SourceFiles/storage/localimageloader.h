@@ -57,7 +57,8 @@ class TaskQueue : public QObject {
 	Q_OBJECT
 
 public:
-	explicit TaskQueue(crl::time stopTimeoutMs = 0); // <= 0 - never stop worker
+	// <= 0 - never stop workers.
+	explicit TaskQueue(crl::time stopTimeoutMs = 0, int workersLimit = 1);
 
 	TaskId addTask(std::unique_ptr<Task> &&task);
 	void addTasks(std::vector<std::unique_ptr<Task>> &&tasks);
@@ -77,13 +78,22 @@ private:
 
 	void wakeThread();
 
+	// Both should be called with _tasksToProcessMutex locked.
+	[[nodiscard]] std::unique_ptr<Task> takeTaskToProcess();
+	[[nodiscard]] bool taskProcessed(std::unique_ptr<Task> task);
+	[[nodiscard]] bool pushProcessedInOrder();
+
+	// Tasks are processed in parallel, but finished in the added order.
 	std::deque<std::unique_ptr<Task>> _tasksToProcess;
+	std::deque<std::unique_ptr<Task>> _tasksProcessed;
 	std::deque<std::unique_ptr<Task>> _tasksToFinish;
-	TaskId _taskInProcessId = TaskId();
+	std::deque<TaskId> _tasksOrder;
+	std::vector<TaskId> _tasksInProcess;
 	QMutex _tasksToProcessMutex, _tasksToFinishMutex;
-	QThread *_thread = nullptr;
-	TaskQueueWorker *_worker = nullptr;
+	std::vector<QThread*> _threads;
+	std::vector<TaskQueueWorker*> _workers;
 	QTimer *_stopTimer = nullptr;
+	int _workersLimit = 1;
 
 };
 
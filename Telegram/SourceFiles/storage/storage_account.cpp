@@ -47,10 +47,15 @@ using Database = Cache::Database;
 
 constexpr auto kDelayedWriteTimeout = crl::time(1000);
 constexpr auto kWriteSearchSuggestionsDelay = 5 * crl::time(1000);
+constexpr auto kMaxHistorySlicesCount = 64;
+constexpr auto kMaxHistorySlicesSize = 16 * 1024 * 1024;
 
 constexpr auto kStickersVersionTag = quint32(-1);
-constexpr auto kStickersSerializeVersion = 4;
+constexpr auto kStickersSerializeVersion = 5;
 constexpr auto kMaxSavedStickerSetsCount = 1000;
+
+// Sticker sets changes are appended until they take half of the snapshot.
+constexpr auto kStickersAppendedSizeMin = 64 * 1024;
 constexpr auto kDefaultStickerInstallDate = TimeId(1);
 
 constexpr auto kSinglePeerTypeUserOld = qint32(1);
@@ -96,6 +101,8 @@ enum { // Local Storage Keys
 	lskWebviewTokens = 0x19, // data: QByteArray bots, QByteArray other
 	lskRoundPlaceholder = 0x1a, // no data
 	lskInlineBotsDownloads = 0x1b, // no data
+	lskHistorySlicesOld = 0x1c, // no data
+	lskHistorySlices = 0x1d, // data: FileKey key, PeerId peer, quint32 size
 };
 
 auto EmptyMessageDraftSources()
@@ -241,6 +248,8 @@ base::flat_set<QString> Account::collectGoodNames() const {
 		result.emplace(name);
 		name[name.size() - 1] = 's';
 		result.emplace(name);
+		name[name.size() - 1] = 'j';
+		result.emplace(name);
 	};
 	for (const auto &[key, value] : _draftsMap) {
 		push(value);
@@ -248,6 +257,9 @@ base::flat_set<QString> Account::collectGoodNames() const {
 	for (const auto &[key, value] : _draftCursorsMap) {
 		push(value);
 	}
+	for (const auto &entry : _historySlices) {
+		push(entry.key);
+	}
 	for (const auto &value : keys) {
 		push(value);
 	}
@@ -312,6 +324,8 @@ Account::ReadMapResult Account::readMapWith(
 	quint64 searchSuggestionsKey = 0;
 	quint64 roundPlaceholderKey = 0;
 	quint64 inlineBotsDownloadsKey = 0;
+	quint64 historySlicesKeyOld = 0;
+	auto historySlices = std::vector<HistorySliceKey>();
 	QByteArray webviewStorageTokenBots, webviewStorageTokenOther;
 	while (!map.stream.atEnd()) {
 		quint32 keyType;
@@ -427,6 +441,24 @@ Account::ReadMapResult Account::readMapWith(
 		case lskInlineBotsDownloads: {
 			map.stream >> inlineBotsDownloadsKey;
 		} break;
+		case lskHistorySlicesOld: {
+			map.stream >> historySlicesKeyOld;
+		} break;
+		case lskHistorySlices: {
+			quint32 count = 0;
+			map.stream >> count;
+			for (quint32 i = 0; i < count; ++i) {
+				FileKey key;
+				quint64 peerIdSerialized;
+				quint32 size;
+				map.stream >> key >> peerIdSerialized >> size;
+				historySlices.push_back({
+					.peerId = DeserializePeerId(peerIdSerialized),
+					.key = key,
+					.size = int(size),
+				});
+			}
+		} break;
 		case lskWebviewTokens: {
 			map.stream
 				>> webviewStorageTokenBots
@@ -470,6 +502,7 @@ Account::ReadMapResult Account::readMapWith(
 	_searchSuggestionsKey = searchSuggestionsKey;
 	_roundPlaceholderKey = roundPlaceholderKey;
 	_inlineBotsDownloadsKey = inlineBotsDownloadsKey;
+	_historySlices = std::move(historySlices);
 	_oldMapVersion = mapData.version;
 	_webviewStorageIdBots.token = webviewStorageTokenBots;
 	_webviewStorageIdOther.token = webviewStorageTokenOther;
@@ -479,6 +512,10 @@ Account::ReadMapResult Account::readMapWith(
 	} else {
 		_mapChanged = false;
 	}
+	if (historySlicesKeyOld) {
+		ClearKey(historySlicesKeyOld, _basePath);
+		writeMapDelayed();
+	}
 
 	if (_locationsKey) {
 		readLocations();
@@ -586,6 +623,10 @@ void Account::writeMap() {
 	}
 	if (_roundPlaceholderKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_inlineBotsDownloadsKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (!_historySlices.empty()) {
+		mapSize += sizeof(quint32) * 2
+			+ _historySlices.size() * (sizeof(quint64) * 2 + sizeof(quint32));
+	}
 
 	EncryptedDescriptor mapData(mapSize);
 	if (!self.isEmpty()) {
@@ -664,6 +705,17 @@ void Account::writeMap() {
 		mapData.stream << quint32(lskInlineBotsDownloads);
 		mapData.stream << quint64(_inlineBotsDownloadsKey);
 	}
+	if (!_historySlices.empty()) {
+		mapData.stream
+			<< quint32(lskHistorySlices)
+			<< quint32(_historySlices.size());
+		for (const auto &entry : _historySlices) {
+			mapData.stream
+				<< quint64(entry.key)
+				<< SerializePeerId(entry.peerId)
+				<< quint32(entry.size);
+		}
+	}
 	map.writeEncrypted(mapData, _localKey);
 
 	_mapChanged = false;
@@ -695,6 +747,8 @@ void Account::reset() {
 	_searchSuggestionsKey = 0;
 	_roundPlaceholderKey = 0;
 	_inlineBotsDownloadsKey = 0;
+	_historySlices.clear();
+	_stickersJournals.clear();
 	_oldMapVersion = 0;
 	_fileLocations.clear();
 	_fileLocationPairs.clear();
@@ -1821,102 +1875,149 @@ void Account::writeStickerSets(
 		FileKey &stickersKey,
 		CheckSet checkSet,
 		const Data::StickersSetsOrder &order) {
-	using SetFlag = Data::StickersSetFlag;
-
 	const auto &sets = _owner->session().data().stickers().sets();
 	if (sets.empty()) {
-		if (stickersKey) {
-			ClearKey(stickersKey, _basePath);
-			stickersKey = 0;
-			writeMapDelayed();
-		}
+		clearStickerSets(stickersKey);
 		return;
 	}
 
-	// versionTag + version + count
-	quint32 size = sizeof(quint32) + sizeof(qint32) + sizeof(qint32);
-
-	int32 setsCount = 0;
+	auto serialized = base::flat_map<uint64, QByteArray>();
+	auto size = 0;
 	for (const auto &[id, set] : sets) {
-		const auto raw = set.get();
-		auto result = checkSet(*raw);
+		auto result = checkSet(*set);
 		if (result == StickerSetCheckResult::Abort) {
 			return;
 		} else if (result == StickerSetCheckResult::Skip) {
 			continue;
 		}
-
-		// id
-		// + accessHash
-		// + hash
-		// + title
-		// + shortName
-		// + stickersCount
-		// + flags
-		// + installDate
-		// + thumbnailDocumentId
-		// + thumbnailType
-		// + thumbnailLocation
-		size += sizeof(quint64) * 3
-			+ Serialize::stringSize(raw->title)
-			+ Serialize::stringSize(raw->shortName)
-			+ sizeof(qint32) * 3
-			+ sizeof(quint64)
-			+ sizeof(qint32)
-			+ Serialize::imageLocationSize(raw->thumbnailLocation());
-		if (raw->flags & SetFlag::NotLoaded) {
-			continue;
-		}
-
-		for (const auto sticker : std::as_const(raw->stickers)) {
-			size += Serialize::Document::sizeInStream(sticker);
-		}
-
-		size += sizeof(qint32); // datesCount
-		if (!raw->dates.empty()) {
-			Assert(raw->stickers.size() == raw->dates.size());
-			size += raw->dates.size() * sizeof(qint32);
+		auto bytes = QByteArray();
+		{
+			QDataStream stream(&bytes, QIODevice::WriteOnly);
+			stream.setVersion(QDataStream::Qt_5_1);
+			writeStickerSet(stream, *set);
 		}
-
-		size += sizeof(qint32); // emojiCount
-		for (auto j = raw->emoji.cbegin(), e = raw->emoji.cend(); j != e; ++j) {
-			size += Serialize::stringSize(j->first->id()) + sizeof(qint32) + (j->second.size() * sizeof(quint64));
+		if (!bytes.isEmpty()) {
+			size += sizeof(quint64) + Serialize::bytearraySize(bytes);
+			serialized.emplace(id, std::move(bytes));
 		}
-
-		++setsCount;
 	}
-	if (!setsCount && order.isEmpty()) {
-		if (stickersKey) {
-			ClearKey(stickersKey, _basePath);
-			stickersKey = 0;
-			writeMapDelayed();
-		}
+	if (serialized.empty() && order.isEmpty()) {
+		clearStickerSets(stickersKey);
 		return;
 	}
-	size += sizeof(qint32) + (order.size() * sizeof(quint64));
 
 	if (!stickersKey) {
 		stickersKey = GenerateKey(_basePath);
 		writeMapQueued();
 	}
+	auto &journal = _stickersJournals[stickersKey];
+	if (journal.sequence
+		&& appendStickerSets(stickersKey, journal, serialized, order)) {
+		return;
+	}
+
+	// versionTag + version + sequence + count + sets + order
+	size += sizeof(quint32) + sizeof(qint32) + sizeof(quint64)
+		+ sizeof(qint32)
+		+ sizeof(qint32) + (order.size() * sizeof(quint64));
+
+	journal.sequence = std::max(journal.sequence, uint64(1));
 	EncryptedDescriptor data(size);
 	data.stream
 		<< quint32(kStickersVersionTag)
 		<< qint32(kStickersSerializeVersion)
-		<< qint32(setsCount);
-	for (const auto &[id, set] : sets) {
-		auto result = checkSet(*set);
-		if (result == StickerSetCheckResult::Abort) {
-			return;
-		} else if (result == StickerSetCheckResult::Skip) {
-			continue;
-		}
-		writeStickerSet(data.stream, *set);
+		<< quint64(journal.sequence)
+		<< qint32(serialized.size());
+	for (const auto &[id, bytes] : serialized) {
+		data.stream << quint64(id) << bytes;
 	}
 	data.stream << order;
+	{
+		FileWriteDescriptor file(stickersKey, _basePath);
+		file.writeEncrypted(data, _localKey);
+	}
 
-	FileWriteDescriptor file(stickersKey, _basePath);
-	file.writeEncrypted(data, _localKey);
+	// Everything appended before is in the snapshot now.
+	ClearAppended(stickersKey, _basePath);
+	journal.sets = std::move(serialized);
+	journal.order = order;
+	journal.appendedSize = 0;
+}
+
+bool Account::appendStickerSets(
+		const FileKey &stickersKey,
+		StickersJournal &journal,
+		const base::flat_map<uint64, QByteArray> &sets,
+		const Data::StickersSetsOrder &order) {
+	auto changed = std::vector<std::pair<uint64, QByteArray>>();
+	auto removed = std::vector<uint64>();
+	auto changedSize = 0;
+	auto totalSize = 0;
+	for (const auto &[id, bytes] : sets) {
+		totalSize += bytes.size();
+		const auto i = journal.sets.find(id);
+		if (i == end(journal.sets) || i->second != bytes) {
+			changedSize += sizeof(quint64) + Serialize::bytearraySize(bytes);
+			changed.emplace_back(id, bytes);
+		}
+	}
+	for (const auto &[id, bytes] : journal.sets) {
+		if (!sets.contains(id)) {
+			removed.push_back(id);
+		}
+	}
+	const auto orderChanged = (order != journal.order);
+	if (changed.empty() && removed.empty() && !orderChanged) {
+		return true;
+	}
+
+	// sequence + appVersion + changed + removed + order
+	const auto size = sizeof(quint64) + sizeof(qint32)
+		+ sizeof(qint32) + changedSize
+		+ sizeof(qint32) + (removed.size() * sizeof(quint64))
+		+ sizeof(qint32) + (order.size() * sizeof(quint64));
+	const auto limit = std::max(totalSize / 2, kStickersAppendedSizeMin);
+	if (journal.appendedSize + int(size) > limit) {
+		return false;
+	}
+
+	EncryptedDescriptor data(size);
+	data.stream
+		<< quint64(journal.sequence + 1)
+		<< qint32(AppVersion)
+		<< qint32(changed.size());
+	for (const auto &[id, bytes] : changed) {
+		data.stream << quint64(id) << bytes;
+	}
+	data.stream << qint32(removed.size());
+	for (const auto id : removed) {
+		data.stream << quint64(id);
+	}
+	data.stream << qint32(orderChanged ? 1 : 0);
+	if (orderChanged) {
+		data.stream << order;
+	}
+	AppendEncrypted(stickersKey, _basePath, data, _localKey);
+
+	++journal.sequence;
+	journal.appendedSize += int(size);
+	for (auto &[id, bytes] : changed) {
+		journal.sets[id] = std::move(bytes);
+	}
+	for (const auto id : removed) {
+		journal.sets.remove(id);
+	}
+	journal.order = order;
+	return true;
+}
+
+void Account::clearStickerSets(FileKey &stickersKey) {
+	if (stickersKey) {
+		_stickersJournals.remove(stickersKey);
+		ClearKey(stickersKey, _basePath);
+		stickersKey = 0;
+		writeMapDelayed();
+	}
 }
 
 void Account::readStickerSets(
@@ -1927,13 +2028,12 @@ void Account::readStickerSets(
 
 	FileReadDescriptor stickers;
 	if (!ReadEncryptedFile(stickers, stickersKey, _basePath, _localKey)) {
-		ClearKey(stickersKey, _basePath);
-		stickersKey = 0;
-		writeMapDelayed();
+		clearStickerSets(stickersKey);
 		return;
 	}
 
 	const auto failed = [&] {
+		_stickersJournals.remove(stickersKey);
 		ClearKey(stickersKey, _basePath);
 		stickersKey = 0;
 	};
@@ -1948,6 +2048,10 @@ void Account::readStickerSets(
 		// Old data, without sticker set thumbnails.
 		return failed();
 	}
+	quint64 sequence = 0;
+	if (version > 4) {
+		stickers.stream >> sequence;
+	}
 	qint32 count = 0;
 	stickers.stream >> count;
 	if (!CheckStreamStatus(stickers.stream)
@@ -1955,220 +2059,138 @@ void Account::readStickerSets(
 		|| (count > kMaxSavedStickerSetsCount)) {
 		return failed();
 	}
-	for (auto i = 0; i != count; ++i) {
-		quint64 setId = 0, setAccessHash = 0, setHash = 0;
-		quint64 setThumbnailDocumentId = 0;
-		QString setTitle, setShortName;
-		qint32 scnt = 0;
-		qint32 setInstallDate = 0;
-		Data::StickersSetFlags setFlags = 0;
-		qint32 setFlagsValue = 0;
-		qint32 setThumbnailType = qint32(StickerType::Webp);
-		ImageLocation setThumbnail;
-
-		stickers.stream
-			>> setId
-			>> setAccessHash
-			>> setHash
-			>> setTitle
-			>> setShortName
-			>> scnt
-			>> setFlagsValue
-			>> setInstallDate;
-		if (version > 2) {
-			stickers.stream >> setThumbnailDocumentId;
-			if (version > 3) {
-				stickers.stream >> setThumbnailType;
+	if (version < 5) {
+		for (auto i = 0; i != count; ++i) {
+			if (!readStickerSet(stickers.stream, stickers.version, version)) {
+				return failed();
 			}
 		}
 
-		constexpr auto kLegacyFlagWebm = (1 << 8);
-		if ((version < 4) && (setFlagsValue & kLegacyFlagWebm)) {
-			setThumbnailType = qint32(StickerType::Webm);
+		// Read orders of installed and featured stickers.
+		if (outOrder) {
+			auto outOrderCount = quint32();
+			stickers.stream >> outOrderCount;
+			if (!CheckStreamStatus(stickers.stream)
+				|| outOrderCount > 1000) {
+				return failed();
+			}
+			outOrder->reserve(outOrderCount);
+			for (auto i = 0; i != outOrderCount; ++i) {
+				auto value = uint64();
+				stickers.stream >> value;
+				if (!CheckStreamStatus(stickers.stream)) {
+					outOrder->clear();
+					return failed();
+				}
+				outOrder->push_back(value);
+			}
 		}
-		const auto thumbnail = Serialize::readImageLocation(
-			stickers.version,
-			stickers.stream);
-		if (!thumbnail || !CheckStreamStatus(stickers.stream)) {
+		if (!CheckStreamStatus(stickers.stream)) {
 			return failed();
-		} else if (thumbnail->valid() && thumbnail->isLegacy()) {
-			// No thumb_version information in legacy location.
+		}
+	} else {
+		auto journal = StickersJournal{ .sequence = sequence };
+		for (auto i = 0; i != count; ++i) {
+			auto id = quint64();
+			auto bytes = QByteArray();
+			stickers.stream >> id >> bytes;
+			journal.sets.emplace(id, std::move(bytes));
+		}
+		stickers.stream >> journal.order;
+		if (!CheckStreamStatus(stickers.stream)
+			|| journal.order.size() > kMaxSavedStickerSetsCount) {
 			return failed();
-		} else {
-			setThumbnail = *thumbnail;
-		}
-
-		setFlags = Data::StickersSetFlags::from_raw(setFlagsValue);
-		if (setId == Data::Stickers::DefaultSetId) {
-			setTitle = tr::lng_stickers_default_set(tr::now);
-			setFlags |= SetFlag::Official | SetFlag::Special;
-		} else if (setId == Data::Stickers::CustomSetId) {
-			setTitle = u"Custom stickers"_q;
-			setFlags |= SetFlag::Special;
-		} else if ((setId == Data::Stickers::CloudRecentSetId)
-				|| (setId == Data::Stickers::CloudRecentAttachedSetId)) {
-			setTitle = tr::lng_recent_stickers(tr::now);
-			setFlags |= SetFlag::Special;
-		} else if (setId == Data::Stickers::FavedSetId) {
-			setTitle = Lang::Hard::FavedSetTitle();
-			setFlags |= SetFlag::Special;
-		} else if (!setId) {
-			continue;
 		}
 
-		auto it = sets.find(setId);
-		auto settingSet = (it == sets.cend());
-		if (settingSet) {
-			// We will set this flags from order lists when reading those stickers.
-			setFlags &= ~(SetFlag::Installed | SetFlag::Featured);
-			it = sets.emplace(setId, std::make_unique<Data::StickersSet>(
-				&_owner->session().data(),
-				setId,
-				setAccessHash,
-				setHash,
-				setTitle,
-				setShortName,
-				0,
-				setFlags,
-				setInstallDate)).first;
-			it->second->thumbnailDocumentId = setThumbnailDocumentId;
-		}
-		const auto set = it->second.get();
-		const auto inputSet = set->identifier();
-		const auto fillStickers = set->stickers.isEmpty();
-
-		if (scnt < 0) { // disabled not loaded set
-			if (!set->count || fillStickers) {
-				set->count = -scnt;
+		// Sets changed after the snapshot may be of another app version.
+		auto versions = base::flat_map<uint64, qint32>();
+		const auto apply = [&](const QByteArray &record) {
+			QDataStream stream(record);
+			stream.setVersion(QDataStream::Qt_5_1);
+			auto recordSequence = quint64();
+			auto appVersion = qint32();
+			auto changedCount = qint32();
+			stream >> recordSequence >> appVersion >> changedCount;
+			if (!CheckStreamStatus(stream)
+				|| (appVersion > AppVersion)
+				|| (changedCount < 0)
+				|| (changedCount > kMaxSavedStickerSetsCount)) {
+				return false;
 			}
-			continue;
-		}
-
-		if (fillStickers) {
-			set->stickers.reserve(scnt);
-			set->count = 0;
-		}
-
-		Serialize::Document::StickerSetInfo info(
-			setId,
-			setAccessHash,
-			setShortName);
-		base::flat_set<DocumentId> read;
-		for (int32 j = 0; j < scnt; ++j) {
-			auto document = Serialize::Document::readStickerFromStream(
-				&_owner->session(),
-				stickers.version,
-				stickers.stream, info);
-			if (!CheckStreamStatus(stickers.stream)) {
-				return failed();
-			} else if (!document
-				|| !document->sticker()
-				|| read.contains(document->id)) {
-				continue;
+			auto changed = std::vector<std::pair<uint64, QByteArray>>();
+			changed.reserve(changedCount);
+			for (auto i = 0; i != changedCount; ++i) {
+				auto id = quint64();
+				auto bytes = QByteArray();
+				stream >> id >> bytes;
+				changed.emplace_back(id, std::move(bytes));
 			}
-			read.emplace(document->id);
-			if (fillStickers) {
-				set->stickers.push_back(document);
-				if (!(set->flags & SetFlag::Special)) {
-					if (!document->sticker()->set.id) {
-						document->sticker()->set = inputSet;
-					}
-				}
-				++set->count;
+			auto removedCount = qint32();
+			stream >> removedCount;
+			if (!CheckStreamStatus(stream)
+				|| (removedCount < 0)
+				|| (removedCount > kMaxSavedStickerSetsCount)) {
+				return false;
 			}
-		}
-
-		qint32 datesCount = 0;
-		stickers.stream >> datesCount;
-		if (datesCount > 0) {
-			if (datesCount != scnt) {
-				return failed();
+			auto removed = std::vector<uint64>();
+			removed.reserve(removedCount);
+			for (auto i = 0; i != removedCount; ++i) {
+				auto id = quint64();
+				stream >> id;
+				removed.push_back(id);
 			}
-			const auto fillDates
-				= ((set->id == Data::Stickers::CloudRecentSetId)
-					|| (set->id == Data::Stickers::CloudRecentAttachedSetId))
-				&& (set->stickers.size() == datesCount);
-			if (fillDates) {
-				set->dates.clear();
-				set->dates.reserve(datesCount);
+			auto orderChanged = qint32();
+			auto order = Data::StickersSetsOrder();
+			stream >> orderChanged;
+			if (orderChanged) {
+				stream >> order;
 			}
-			for (auto i = 0; i != datesCount; ++i) {
-				qint32 date = 0;
-				stickers.stream >> date;
-				if (fillDates) {
-					set->dates.push_back(TimeId(date));
-				}
+			if (!CheckStreamStatus(stream)) {
+				return false;
+			} else if (recordSequence <= journal.sequence) {
+				// Already in the snapshot.
+				return true;
 			}
-		}
-
-		qint32 emojiCount = 0;
-		stickers.stream >> emojiCount;
-		if (!CheckStreamStatus(stickers.stream) || emojiCount < 0) {
-			return failed();
-		}
-		for (int32 j = 0; j < emojiCount; ++j) {
-			QString emojiString;
-			qint32 stickersCount;
-			stickers.stream >> emojiString >> stickersCount;
-			Data::StickersPack pack;
-			pack.reserve(stickersCount);
-			for (int32 k = 0; k < stickersCount; ++k) {
-				quint64 id;
-				stickers.stream >> id;
-				const auto doc = _owner->session().data().document(id);
-				if (!doc->sticker()) continue;
-
-				pack.push_back(doc);
+			for (auto &[id, bytes] : changed) {
+				journal.sets[id] = std::move(bytes);
+				versions[id] = appVersion;
 			}
-			if (fillStickers) {
-				if (auto emoji = Ui::Emoji::Find(emojiString)) {
-					emoji = emoji->original();
-					set->emoji[emoji] = std::move(pack);
-				}
+			for (const auto id : removed) {
+				journal.sets.remove(id);
+				versions.remove(id);
 			}
-		}
-
-		if (settingSet) {
-			if (version < 4
-				&& setThumbnailType == qint32(StickerType::Webp)
-				&& !set->stickers.empty()
-				&& set->stickers.front()->sticker()) {
-				const auto first = set->stickers.front();
-				setThumbnailType = qint32(first->sticker()->type);
+			if (orderChanged) {
+				journal.order = std::move(order);
+			}
+			journal.sequence = recordSequence;
+			journal.appendedSize += record.size();
+			return true;
+		};
+		const auto appended = ReadEncryptedAppended(
+			stickersKey,
+			_basePath,
+			_localKey);
+		for (const auto &record : appended) {
+			if (!apply(record)) {
+				break;
 			}
-			const auto thumbType = [&] {
-				switch (setThumbnailType) {
-				case qint32(StickerType::Webp): return StickerType::Webp;
-				case qint32(StickerType::Tgs): return StickerType::Tgs;
-				case qint32(StickerType::Webm): return StickerType::Webm;
-				}
-				return StickerType::Webp;
-			}();
-			set->setThumbnail(
-				ImageWithLocation{ .location = setThumbnail }, thumbType);
 		}
-	}
 
-	// Read orders of installed and featured stickers.
-	if (outOrder) {
-		auto outOrderCount = quint32();
-		stickers.stream >> outOrderCount;
-		if (!CheckStreamStatus(stickers.stream) || outOrderCount > 1000) {
-			return failed();
-		}
-		outOrder->reserve(outOrderCount);
-		for (auto i = 0; i != outOrderCount; ++i) {
-			auto value = uint64();
-			stickers.stream >> value;
-			if (!CheckStreamStatus(stickers.stream)) {
-				outOrder->clear();
+		for (const auto &[id, bytes] : journal.sets) {
+			const auto i = versions.find(id);
+			const auto appVersion = (i != end(versions))
+				? i->second
+				: stickers.version;
+			QDataStream stream(bytes);
+			stream.setVersion(QDataStream::Qt_5_1);
+			if (!readStickerSet(stream, appVersion, version)) {
 				return failed();
 			}
-			outOrder->push_back(value);
 		}
-	}
-	if (!CheckStreamStatus(stickers.stream)) {
-		return failed();
+		if (outOrder) {
+			*outOrder = journal.order;
+		}
+		_stickersJournals[stickersKey] = std::move(journal);
 	}
 
 	// Set flags that we dropped above from the order.
@@ -2187,6 +2209,207 @@ void Account::readStickerSets(
 	}
 }
 
+bool Account::readStickerSet(
+		QDataStream &stream,
+		qint32 appVersion,
+		qint32 version) {
+	using SetFlag = Data::StickersSetFlag;
+
+	auto &sets = _owner->session().data().stickers().setsRef();
+	quint64 setId = 0, setAccessHash = 0, setHash = 0;
+	quint64 setThumbnailDocumentId = 0;
+	QString setTitle, setShortName;
+	qint32 scnt = 0;
+	qint32 setInstallDate = 0;
+	Data::StickersSetFlags setFlags = 0;
+	qint32 setFlagsValue = 0;
+	qint32 setThumbnailType = qint32(StickerType::Webp);
+	ImageLocation setThumbnail;
+
+	stream
+		>> setId
+		>> setAccessHash
+		>> setHash
+		>> setTitle
+		>> setShortName
+		>> scnt
+		>> setFlagsValue
+		>> setInstallDate;
+	if (version > 2) {
+		stream >> setThumbnailDocumentId;
+		if (version > 3) {
+			stream >> setThumbnailType;
+		}
+	}
+
+	constexpr auto kLegacyFlagWebm = (1 << 8);
+	if ((version < 4) && (setFlagsValue & kLegacyFlagWebm)) {
+		setThumbnailType = qint32(StickerType::Webm);
+	}
+	const auto thumbnail = Serialize::readImageLocation(
+		appVersion,
+		stream);
+	if (!thumbnail || !CheckStreamStatus(stream)) {
+		return false;
+	} else if (thumbnail->valid() && thumbnail->isLegacy()) {
+		// No thumb_version information in legacy location.
+		return false;
+	} else {
+		setThumbnail = *thumbnail;
+	}
+
+	setFlags = Data::StickersSetFlags::from_raw(setFlagsValue);
+	if (setId == Data::Stickers::DefaultSetId) {
+		setTitle = tr::lng_stickers_default_set(tr::now);
+		setFlags |= SetFlag::Official | SetFlag::Special;
+	} else if (setId == Data::Stickers::CustomSetId) {
+		setTitle = u"Custom stickers"_q;
+		setFlags |= SetFlag::Special;
+	} else if ((setId == Data::Stickers::CloudRecentSetId)
+			|| (setId == Data::Stickers::CloudRecentAttachedSetId)) {
+		setTitle = tr::lng_recent_stickers(tr::now);
+		setFlags |= SetFlag::Special;
+	} else if (setId == Data::Stickers::FavedSetId) {
+		setTitle = Lang::Hard::FavedSetTitle();
+		setFlags |= SetFlag::Special;
+	} else if (!setId) {
+		return true;
+	}
+
+	auto it = sets.find(setId);
+	auto settingSet = (it == sets.cend());
+	if (settingSet) {
+		// We will set this flags from order lists when reading those stickers.
+		setFlags &= ~(SetFlag::Installed | SetFlag::Featured);
+		it = sets.emplace(setId, std::make_unique<Data::StickersSet>(
+			&_owner->session().data(),
+			setId,
+			setAccessHash,
+			setHash,
+			setTitle,
+			setShortName,
+			0,
+			setFlags,
+			setInstallDate)).first;
+		it->second->thumbnailDocumentId = setThumbnailDocumentId;
+	}
+	const auto set = it->second.get();
+	const auto inputSet = set->identifier();
+	const auto fillStickers = set->stickers.isEmpty();
+
+	if (scnt < 0) { // disabled not loaded set
+		if (!set->count || fillStickers) {
+			set->count = -scnt;
+		}
+		return true;
+	}
+
+	if (fillStickers) {
+		set->stickers.reserve(scnt);
+		set->count = 0;
+	}
+
+	Serialize::Document::StickerSetInfo info(
+		setId,
+		setAccessHash,
+		setShortName);
+	base::flat_set<DocumentId> read;
+	for (int32 j = 0; j < scnt; ++j) {
+		auto document = Serialize::Document::readStickerFromStream(
+			&_owner->session(),
+			appVersion,
+			stream, info);
+		if (!CheckStreamStatus(stream)) {
+			return false;
+		} else if (!document
+			|| !document->sticker()
+			|| read.contains(document->id)) {
+			continue;
+		}
+		read.emplace(document->id);
+		if (fillStickers) {
+			set->stickers.push_back(document);
+			if (!(set->flags & SetFlag::Special)) {
+				if (!document->sticker()->set.id) {
+					document->sticker()->set = inputSet;
+				}
+			}
+			++set->count;
+		}
+	}
+
+	qint32 datesCount = 0;
+	stream >> datesCount;
+	if (datesCount > 0) {
+		if (datesCount != scnt) {
+			return false;
+		}
+		const auto fillDates
+			= ((set->id == Data::Stickers::CloudRecentSetId)
+				|| (set->id == Data::Stickers::CloudRecentAttachedSetId))
+			&& (set->stickers.size() == datesCount);
+		if (fillDates) {
+			set->dates.clear();
+			set->dates.reserve(datesCount);
+		}
+		for (auto i = 0; i != datesCount; ++i) {
+			qint32 date = 0;
+			stream >> date;
+			if (fillDates) {
+				set->dates.push_back(TimeId(date));
+			}
+		}
+	}
+
+	qint32 emojiCount = 0;
+	stream >> emojiCount;
+	if (!CheckStreamStatus(stream) || emojiCount < 0) {
+		return false;
+	}
+	for (int32 j = 0; j < emojiCount; ++j) {
+		QString emojiString;
+		qint32 stickersCount;
+		stream >> emojiString >> stickersCount;
+		Data::StickersPack pack;
+		pack.reserve(stickersCount);
+		for (int32 k = 0; k < stickersCount; ++k) {
+			quint64 id;
+			stream >> id;
+			const auto doc = _owner->session().data().document(id);
+			if (!doc->sticker()) continue;
+
+			pack.push_back(doc);
+		}
+		if (fillStickers) {
+			if (auto emoji = Ui::Emoji::Find(emojiString)) {
+				emoji = emoji->original();
+				set->emoji[emoji] = std::move(pack);
+			}
+		}
+	}
+
+	if (settingSet) {
+		if (version < 4
+			&& setThumbnailType == qint32(StickerType::Webp)
+			&& !set->stickers.empty()
+			&& set->stickers.front()->sticker()) {
+			const auto first = set->stickers.front();
+			setThumbnailType = qint32(first->sticker()->type);
+		}
+		const auto thumbType = [&] {
+			switch (setThumbnailType) {
+			case qint32(StickerType::Webp): return StickerType::Webp;
+			case qint32(StickerType::Tgs): return StickerType::Tgs;
+			case qint32(StickerType::Webm): return StickerType::Webm;
+			}
+			return StickerType::Webp;
+		}();
+		set->setThumbnail(
+			ImageWithLocation{ .location = setThumbnail }, thumbType);
+	}
+	return true;
+}
+
 void Account::writeInstalledStickers() {
 	using SetFlag = Data::StickersSetFlag;
 
@@ -2790,6 +3013,7 @@ void Account::writeExportSettings(const Export::Settings &settings) {
 		&& settings.fullChats == check.fullChats
 		&& settings.media.types == check.media.types
 		&& settings.media.sizeLimit == check.media.sizeLimit
+		&& settings.media.requestsPerDc == check.media.requestsPerDc
 		&& settings.path == check.path
 		&& settings.format == check.format
 		&& settings.availableAt == check.availableAt
@@ -2807,7 +3031,7 @@ void Account::writeExportSettings(const Export::Settings &settings) {
 	}
 	quint32 size = sizeof(quint32) * 6
 		+ Serialize::stringSize(settings.path)
-		+ sizeof(qint32) * 2 + sizeof(quint64);
+		+ sizeof(qint32) * 3 + sizeof(quint64);
 	EncryptedDescriptor data(size);
 	data.stream
 		<< quint32(settings.types)
@@ -2840,6 +3064,7 @@ void Account::writeExportSettings(const Export::Settings &settings) {
 	});
 	data.stream << qint32(settings.singlePeerFrom);
 	data.stream << qint32(settings.singlePeerTill);
+	data.stream << qint32(settings.media.requestsPerDc);
 
 	FileWriteDescriptor file(_exportSettingsKey, _basePath);
 	file.writeEncrypted(data, _localKey);
@@ -2862,6 +3087,7 @@ Export::Settings Account::readExportSettings() {
 	quint64 singlePeerBareId = 0;
 	quint64 singlePeerAccessHash = 0;
 	qint32 singlePeerFrom = 0, singlePeerTill = 0;
+	qint32 requestsPerDc = Export::MediaSettings().requestsPerDc;
 	file.stream
 		>> types
 		>> fullChats
@@ -2892,11 +3118,15 @@ Export::Settings Account::readExportSettings() {
 	if (!file.stream.atEnd()) {
 		file.stream >> singlePeerFrom >> singlePeerTill;
 	}
+	if (!file.stream.atEnd()) {
+		file.stream >> requestsPerDc;
+	}
 	auto result = Export::Settings();
 	result.types = Export::Settings::Types::from_raw(types);
 	result.fullChats = Export::Settings::Types::from_raw(fullChats);
 	result.media.types = Export::MediaSettings::Types::from_raw(mediaTypes);
 	result.media.sizeLimit = mediaSizeLimit;
+	result.media.requestsPerDc = requestsPerDc;
 	result.format = Export::Output::Format(format);
 	result.path = path;
 	result.availableAt = availableAt;
@@ -3290,6 +3520,116 @@ void Account::writeInlineBotsDownloads(const QByteArray &bytes) {
 	file.writeEncrypted(data, _localKey);
 }
 
+void Account::writeHistorySlice(
+		PeerId peerId,
+		const MTPmessages_Messages &slice) {
+	if (!_localKey || slice.type() == mtpc_messages_messagesNotModified) {
+		return;
+	}
+	auto buffer = mtpBuffer();
+	slice.write(buffer);
+	const auto serialized = QByteArray::fromRawData(
+		reinterpret_cast<const char*>(buffer.constData()),
+		buffer.size() * sizeof(mtpPrime));
+
+	const auto i = ranges::find(
+		_historySlices,
+		peerId,
+		&HistorySliceKey::peerId);
+	auto added = HistorySliceKey{ .peerId = peerId };
+	if (i != end(_historySlices)) {
+		added.key = i->key;
+		_historySlices.erase(i);
+	} else {
+		added.key = GenerateKey(_basePath);
+	}
+	added.size = serialized.size();
+	_historySlices.insert(begin(_historySlices), added);
+
+	// Each chat has its own file, only the opened one is written.
+	EncryptedDescriptor data(Serialize::bytearraySize(serialized));
+	data.stream << serialized;
+	FileWriteDescriptor file(added.key, _basePath);
+	file.writeEncrypted(data, _localKey);
+
+	auto total = 0;
+	const auto tooMuch = ranges::find_if(_historySlices, [&](
+			const HistorySliceKey &entry) {
+		total += entry.size;
+		return (total > kMaxHistorySlicesSize);
+	});
+	const auto from = std::min(
+		tooMuch,
+		begin(_historySlices) + std::min(
+			int(_historySlices.size()),
+			kMaxHistorySlicesCount));
+	for (auto j = from; j != end(_historySlices); ++j) {
+		ClearKey(j->key, _basePath);
+	}
+	_historySlices.erase(from, end(_historySlices));
+	writeMapDelayed();
+}
+
+std::optional<MTPmessages_Messages> Account::readHistorySlice(
+		PeerId peerId) {
+	const auto i = ranges::find(
+		_historySlices,
+		peerId,
+		&HistorySliceKey::peerId);
+	if (i == end(_historySlices)) {
+		return std::nullopt;
+	}
+	FileReadDescriptor slice;
+	if (!ReadEncryptedFile(slice, i->key, _basePath, _localKey)) {
+		clearHistorySlice(peerId);
+		return std::nullopt;
+	}
+	auto serialized = QByteArray();
+	slice.stream >> serialized;
+	if (!CheckStreamStatus(slice.stream)) {
+		clearHistorySlice(peerId);
+		return std::nullopt;
+	}
+	auto from = reinterpret_cast<const mtpPrime*>(serialized.constData());
+	const auto till = from + (serialized.size() / sizeof(mtpPrime));
+	auto result = MTPmessages_Messages();
+	if (!result.read(from, till) || from != till) {
+		LOG(("App Error: could not read history slice for peer %1."
+			).arg(peerId.value));
+		clearHistorySlice(peerId);
+		return std::nullopt;
+	}
+	return result;
+}
+
+void Account::clearHistorySlice(PeerId peerId) {
+	const auto i = ranges::find(
+		_historySlices,
+		peerId,
+		&HistorySliceKey::peerId);
+	if (i == end(_historySlices)) {
+		return;
+	}
+	ClearKey(i->key, _basePath);
+	_historySlices.erase(i);
+	writeMapDelayed();
+}
+
+void Account::clearNonChannelHistorySlices() {
+	const auto removed = ranges::remove_if(_historySlices, [&](
+			const HistorySliceKey &entry) {
+		if (peerIsChannel(entry.peerId)) {
+			return false;
+		}
+		ClearKey(entry.key, _basePath);
+		return true;
+	});
+	if (removed != end(_historySlices)) {
+		_historySlices.erase(removed, end(_historySlices));
+		writeMapDelayed();
+	}
+}
+
 bool Account::encrypt(
 		const void *src,
 		void *dst,
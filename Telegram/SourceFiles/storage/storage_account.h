@@ -180,6 +180,12 @@ public:
 	[[nodiscard]] QByteArray readInlineBotsDownloads();
 	void writeInlineBotsDownloads(const QByteArray &bytes);
 
+	void writeHistorySlice(PeerId peerId, const MTPmessages_Messages &slice);
+	[[nodiscard]] std::optional<MTPmessages_Messages> readHistorySlice(
+		PeerId peerId);
+	void clearHistorySlice(PeerId peerId);
+	void clearNonChannelHistorySlices();
+
 	[[nodiscard]] bool encrypt(
 		const void *src,
 		void *dst,
@@ -206,6 +212,20 @@ private:
 	};
 	friend inline constexpr bool is_flag_type(BotTrustFlag) { return true; };
 
+	struct HistorySliceKey {
+		PeerId peerId = 0;
+		FileKey key = 0;
+		int size = 0;
+	};
+
+	// What is stored on disk for a sticker sets key, snapshot + appended.
+	struct StickersJournal {
+		base::flat_map<uint64, QByteArray> sets;
+		Data::StickersSetsOrder order;
+		uint64 sequence = 0;
+		int appendedSize = 0;
+	};
+
 	[[nodiscard]] base::flat_set<QString> collectGoodNames() const;
 	[[nodiscard]] auto prepareReadSettingsContext() const
 		-> details::ReadSettingsContext;
@@ -251,10 +271,20 @@ private:
 		FileKey &stickersKey,
 		CheckSet checkSet,
 		const Data::StickersSetsOrder &order);
+	[[nodiscard]] bool appendStickerSets(
+		const FileKey &stickersKey,
+		StickersJournal &journal,
+		const base::flat_map<uint64, QByteArray> &sets,
+		const Data::StickersSetsOrder &order);
+	void clearStickerSets(FileKey &stickersKey);
 	void readStickerSets(
 		FileKey &stickersKey,
 		Data::StickersSetsOrder *outOrder = nullptr,
 		Data::StickersSetFlags readingFlags = 0);
+	[[nodiscard]] bool readStickerSet(
+		QDataStream &stream,
+		qint32 appVersion,
+		qint32 version);
 	void importOldRecentStickers();
 
 	void readTrustedBots();
@@ -310,6 +340,7 @@ private:
 	FileKey _searchSuggestionsKey = 0;
 	FileKey _roundPlaceholderKey = 0;
 	FileKey _inlineBotsDownloadsKey = 0;
+	base::flat_map<FileKey, StickersJournal> _stickersJournals;
 
 	qint64 _cacheTotalSizeLimit = 0;
 	qint64 _cacheBigFileTotalSizeLimit = 0;
@@ -336,6 +367,9 @@ private:
 
 	QImage _roundPlaceholder;
 
+	// Most recently written first.
+	std::vector<HistorySliceKey> _historySlices;
+
 };
 
 [[nodiscard]] Webview::StorageId TonSiteStorageId();
@@ -18,10 +18,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtCore/QSemaphore>
 #include <QtCore/QMimeData>
+#include <QtCore/QThread>
 
 namespace Storage {
 namespace {
 
+// Each decoded photo may take hundreds of megabytes while prepared.
+constexpr auto kPrepareDetailsThreadsMax = 4;
+
 using Ui::PreparedFileInformation;
 using Ui::PreparedFile;
 using Ui::PreparedList;
@@ -55,6 +59,14 @@ QSize PrepareShownDimensions(const QImage &preview, int sideLimit) {
 		: result;
 }
 
+[[nodiscard]] int PrepareDetailsThreads() {
+	static const auto result = std::clamp(
+		QThread::idealThreadCount(),
+		1,
+		kPrepareDetailsThreadsMax);
+	return result;
+}
+
 void PrepareDetailsInParallel(PreparedList &result, int previewWidth) {
 	Expects(result.files.size() <= Ui::MaxAlbumItems());
 
@@ -62,14 +74,19 @@ void PrepareDetailsInParallel(PreparedList &result, int previewWidth) {
 		return;
 	}
 	const auto sideLimit = PhotoSideLimit(); // Get on main thread.
+	const auto count = int(result.files.size());
+	const auto threads = std::min(count, PrepareDetailsThreads());
+	auto next = std::atomic<int>(0);
 	QSemaphore semaphore;
-	for (auto &file : result.files) {
-		crl::async([=, &semaphore, &file] {
-			PrepareDetails(file, previewWidth, sideLimit);
+	for (auto i = 0; i != threads; ++i) {
+		crl::async([=, &semaphore, &next, &result] {
+			for (auto index = next++; index < count; index = next++) {
+				PrepareDetails(result.files[index], previewWidth, sideLimit);
+			}
 			semaphore.release();
 		});
 	}
-	semaphore.acquire(result.files.size());
+	semaphore.acquire(threads);
 }
 
 } // namespace
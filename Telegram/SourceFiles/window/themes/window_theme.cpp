@@ -48,6 +48,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <QtGui/QGuiApplication>
 #include <QtGui/QStyleHints>
 
+#include <xxhash.h>
+
 namespace Window {
 namespace Theme {
 namespace {
@@ -56,6 +58,7 @@ constexpr auto kThemeFileSizeLimit = 5 * 1024 * 1024;
 constexpr auto kBackgroundSizeLimit = 25 * 1024 * 1024;
 constexpr auto kNightThemeFile = ":/gui/night.tdesktop-theme"_cs;
 constexpr auto kDarkValueThreshold = 0.5;
+constexpr auto kPreparedCacheSize = 3;
 
 struct Applying {
 	Saved data;
@@ -443,6 +446,16 @@ bool InitializeFromSaved(Saved &&saved) {
 	return true;
 }
 
+[[nodiscard]] uint64 PreparedImageHash(const QImage &image) {
+	if (image.isNull()) {
+		return 0;
+	}
+	const auto seed = (uint64(image.width()) << 32)
+		| (uint64(image.height()) << 8)
+		| uint64(image.format());
+	return XXH64(image.constBits(), image.sizeInBytes(), seed);
+}
+
 [[nodiscard]] QImage PostprocessBackgroundImage(
 		QImage image,
 		const Data::WallPaper &paper) {
@@ -700,6 +713,23 @@ void ChatBackground::set(const Data::WallPaper &paper, QImage image) {
 }
 
 void ChatBackground::setPreparedAfterPaper(QImage image) {
+	// Switching between the day and night themes re-applies the same
+	// papers, so keep a few recent results instead of blurring again.
+	const auto paper = _paper.serialize();
+	const auto ratio = style::DevicePixelRatio();
+	const auto hash = PreparedImageHash(image);
+	const auto i = ranges::find_if(_preparedCache, [&](
+			const PreparedCache &entry) {
+		return (entry.hash == hash)
+			&& (entry.ratio == ratio)
+			&& (entry.paper == paper);
+	});
+	if (i != end(_preparedCache)) {
+		std::rotate(i, i + 1, end(_preparedCache));
+		applyPrepared(_preparedCache.back());
+		return;
+	}
+
 	const auto &bgColors = _paper.backgroundColors();
 	if (_paper.isPattern() && !image.isNull()) {
 		if (bgColors.size() < 2) {
@@ -734,6 +764,20 @@ void ChatBackground::setPreparedAfterPaper(QImage image) {
 		image = postprocessBackgroundImage(std::move(image));
 		setPrepared(image, image, QImage());
 	}
+
+	if (_preparedCache.size() == kPreparedCacheSize) {
+		_preparedCache.erase(begin(_preparedCache));
+	}
+	_preparedCache.push_back({
+		.paper = paper,
+		.hash = hash,
+		.ratio = ratio,
+		.original = _original,
+		.prepared = _prepared,
+		.preparedForTiled = _preparedForTiled,
+		.gradient = _gradient,
+		.imageMonoColor = _imageMonoColor,
+	});
 }
 
 void ChatBackground::setPrepared(
@@ -747,22 +791,34 @@ void ChatBackground::setPrepared(
 	if (!prepared.isNull() && !_paper.isPattern() && _paper.isBlurred()) {
 		prepared = Ui::PrepareBlurredBackground(std::move(prepared));
 	}
+	const auto imageMonoColor = gradient.isNull()
+		? Ui::CalculateImageMonoColor(prepared)
+		: std::nullopt;
+	auto preparedForTiled = Ui::PrepareImageForTiled(prepared);
+	applyPrepared({
+		.original = std::move(original),
+		.prepared = std::move(prepared),
+		.preparedForTiled = std::move(preparedForTiled),
+		.gradient = std::move(gradient),
+		.imageMonoColor = imageMonoColor,
+	});
+}
+
+void ChatBackground::applyPrepared(const PreparedCache &prepared) {
 	if (adjustPaletteRequired()) {
-		if ((prepared.isNull() || _paper.isPattern())
+		if ((prepared.prepared.isNull() || _paper.isPattern())
 			&& !_paper.backgroundColors().empty()) {
 			adjustPaletteUsingColors(_paper.backgroundColors());
-		} else if (!prepared.isNull()) {
-			adjustPaletteUsingBackground(prepared);
+		} else if (!prepared.prepared.isNull()) {
+			adjustPaletteUsingBackground(prepared.prepared);
 		}
 	}
 
-	_original = std::move(original);
-	_prepared = std::move(prepared);
-	_gradient = std::move(gradient);
-	_imageMonoColor = _gradient.isNull()
-		? Ui::CalculateImageMonoColor(_prepared)
-		: std::nullopt;
-	_preparedForTiled = Ui::PrepareImageForTiled(_prepared);
+	_original = prepared.original;
+	_prepared = prepared.prepared;
+	_gradient = prepared.gradient;
+	_imageMonoColor = prepared.imageMonoColor;
+	_preparedForTiled = prepared.preparedForTiled;
 }
 
 void ChatBackground::setPaper(const Data::WallPaper &paper) {
@@ -218,12 +218,23 @@ private:
 		style::color item;
 		QColor original;
 	};
+	struct PreparedCache {
+		QByteArray paper;
+		uint64 hash = 0;
+		int ratio = 0;
+		QImage original;
+		QImage prepared;
+		QImage preparedForTiled;
+		QImage gradient;
+		std::optional<QColor> imageMonoColor;
+	};
 
 	[[nodiscard]] bool started() const;
 	void initialRead();
 	void saveForRevert();
 	void setPreparedAfterPaper(QImage image);
 	void setPrepared(QImage original, QImage prepared, QImage gradient);
+	void applyPrepared(const PreparedCache &prepared);
 	void prepareImageForTiled();
 	void writeNewBackgroundSettings();
 	void setPaper(const Data::WallPaper &paper);
@@ -277,6 +288,7 @@ private:
 	std::optional<bool> _localStoredTileNightValue;
 
 	std::optional<QColor> _imageMonoColor;
+	std::vector<PreparedCache> _preparedCache;
 
 	Object _themeObject;
 	QImage _themeImage;